@@ -0,0 +1,145 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "AutoPlayer.h"
+#include "BoardFeatures.h"
+#include <algorithm>
+
+double evaluateBoard(const Board &board, int linesCleared,
+                     const HeuristicWeights &weights) {
+  BoardFeatures features;
+  computeFeatures(board, features);
+
+  return weights.aggregateHeight * features.aggregateHeight +
+         weights.linesCleared * linesCleared + weights.holes * features.holes +
+         weights.bumpiness * features.bumpiness +
+         weights.wells * features.wells +
+         weights.rowTransitions * features.rowTransitions;
+}
+
+// ____________________________________________________________________________
+
+AutoPlayer::AutoPlayer(int beamWidth, ThreadPool *threadPool)
+    : beamWidth_(beamWidth), threadPool_(threadPool) {}
+
+// ____________________________________________________________________________
+
+void AutoPlayer::expand(const Node &node, TetrominoType type, int depth,
+                        std::vector<Node> &children) const {
+  // Topped out boards end the game
+  if (!node.board.isRowEmpty(0)) {
+    return;
+  }
+
+  Tetromino tetromino(type);
+  std::vector<Placement> placements;
+  generatePlacements(node.board, type, placements);
+
+  for (const Placement &p : placements) {
+    Node child = node;
+    if (depth == 0) {
+      child.first = p;
+    }
+    child.board.place(tetromino.getMaskShape(p.rotation), p.x, p.y,
+                      tetromino.getColor());
+    child.linesCleared += child.board.clearFullLines();
+
+    // Only choose a topped out board if there is nothing else
+    child.score = child.board.isRowEmpty(0)
+                      ? evaluateBoard(child.board, child.linesCleared, weights_)
+                      : -1e9;
+    children.push_back(child);
+  }
+}
+
+// ____________________________________________________________________________
+
+void AutoPlayer::appendNew(std::vector<Node> &children, int depth,
+                           std::vector<Node> &next) {
+  for (Node &child : children) {
+    // Equal boards on the same depth also cleared the same number of lines,
+    // so they have the same score and the same subtree. Keep the first one.
+    std::uint64_t key =
+        child.board.getHash() ^ (depth + 1) * 0x9E3779B97F4A7C15ULL;
+    std::uint64_t search;
+    if (table_.probe(key, search) && search == search_) {
+      continue;
+    }
+    table_.store(key, search_);
+    next.push_back(std::move(child));
+  }
+}
+
+// ____________________________________________________________________________
+
+bool AutoPlayer::choose(const Board &board,
+                        const std::vector<TetrominoType> &pieces,
+                        Placement &result) {
+  if (pieces.empty()) {
+    return false;
+  }
+
+  // Entries of earlier searches don't count
+  search_++;
+
+  // The first depth decides which placement every node came from
+  std::vector<Node> firstChildren;
+  expand(Node{board, Placement{0, 0, 0}, 0, 0.0}, pieces[0], 0,
+         firstChildren);
+  std::vector<Node> beam;
+  appendNew(firstChildren, 0, beam);
+  if (beam.empty()) {
+    return false;
+  }
+
+  auto better = [](const Node &a, const Node &b) { return a.score > b.score; };
+
+  for (std::size_t depth = 1; depth < pieces.size(); ++depth) {
+    // Keep only the best boards
+    if (static_cast<int>(beam.size()) > beamWidth_) {
+      std::partial_sort(beam.begin(), beam.begin() + beamWidth_, beam.end(),
+                        better);
+      beam.resize(beamWidth_);
+    }
+
+    // Expand every board of the beam, in parallel if possible
+    std::vector<std::vector<Node>> children(beam.size());
+    auto expandOne = [&](int i) {
+      expand(beam[i], pieces[depth], static_cast<int>(depth), children[i]);
+    };
+    if (threadPool_ != nullptr) {
+      threadPool_->parallelFor(static_cast<int>(beam.size()), expandOne);
+    } else {
+      for (std::size_t i = 0; i < beam.size(); ++i) {
+        expandOne(static_cast<int>(i));
+      }
+    }
+
+    // Drop repeated boards in the order of the beam, not in the order the
+    // workers finished, so the result doesn't depend on the threads
+    std::vector<Node> next;
+    for (std::vector<Node> &nodeChildren : children) {
+      appendNew(nodeChildren, static_cast<int>(depth), next);
+    }
+    // If every continuation tops out, decide on the previous depth
+    if (next.empty()) {
+      break;
+    }
+    beam = std::move(next);
+  }
+
+  result = std::min_element(beam.begin(), beam.end(), better)->first;
+  return true;
+}
+
+// ____________________________________________________________________________
+
+bool AutoPlayer::playMove(Game &game, int lookahead) {
+  std::vector<TetrominoType> pieces = {game.getCurrentType()};
+  for (int i = 0; i + 1 < lookahead && i <= PieceQueue::maxPreview_; ++i) {
+    pieces.push_back(game.getUpcomingType(i));
+  }
+
+  Placement placement{};
+  return choose(game.getBoard(), pieces, placement) && game.placeAt(placement);
+}
@@ -0,0 +1,85 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#pragma once
+
+#include "Board.h"
+#include "Game.h"
+#include "MoveGenerator.h"
+#include "Tetromino.h"
+#include "ThreadPool.h"
+#include "TranspositionTable.h"
+#include <cstdint>
+#include <vector>
+
+// Weights of the board heuristic. Higher scores are better.
+struct HeuristicWeights {
+  double aggregateHeight = -0.510066;
+  double linesCleared = 0.760666;
+  double holes = -0.35663;
+  double bumpiness = -0.184483;
+  double wells = 0;
+  double rowTransitions = 0;
+};
+
+// Score a board with the heuristic: sum of the column heights, lines cleared
+// on the way to this board, holes (empty pixels with a filled one above),
+// bumpiness (height differences of neighbouring columns), wells and row
+// transitions, see BoardFeatures.
+double evaluateBoard(const Board &board, int linesCleared,
+                     const HeuristicWeights &weights = HeuristicWeights());
+
+// Chooses placements with a beam search over the known pieces. Every depth
+// places the next piece in all reachable ways on each board of the beam and
+// keeps the `beamWidth` best boards. The expansion of the beam runs on the
+// thread pool, if one is given. A board which is reached again on the same
+// depth through another order of placements is the same subtree, a
+// transposition table keeps it from being expanded twice.
+class AutoPlayer {
+public:
+  AutoPlayer(int beamWidth = 16, ThreadPool *threadPool = nullptr);
+
+  // Choose a placement for pieces[0] on the board, looking ahead at the
+  // following pieces. Return false if there is no placement (top out).
+  bool choose(const Board &board, const std::vector<TetrominoType> &pieces,
+              Placement &result);
+
+  // Choose a placement for the current tetromino of the game and place it,
+  // looking at `lookahead` pieces in total (the current one, the next one
+  // and the preview queue). Return false if nothing was placed.
+  bool playMove(Game &game, int lookahead = 2);
+
+  // Set the weights of the heuristic.
+  void setWeights(const HeuristicWeights &weights) { weights_ = weights; }
+
+private:
+  // A board in the beam, with the placement of the first piece it came from.
+  struct Node {
+    Board board;
+    Placement first;
+    int linesCleared;
+    double score;
+  };
+
+  // Append all children of `node` for the given piece to `children`. On the
+  // first depth, the children remember their placement. Runs in parallel for
+  // the nodes of the beam.
+  void expand(const Node &node, TetrominoType type, int depth,
+              std::vector<Node> &children) const;
+
+  // Move the children to `next`, except boards which were already reached on
+  // this depth. Runs on one thread, in the order of the beam, so ties keep
+  // the same node with and without the thread pool.
+  void appendNew(std::vector<Node> &children, int depth,
+                 std::vector<Node> &next);
+
+  int beamWidth_;
+  ThreadPool *threadPool_;
+  HeuristicWeights weights_;
+
+  // Boards reached in the search, by hash of board and depth. The value is
+  // the search (call of choose) which reached it, so the table never has to
+  // be cleared.
+  TranspositionTable table_;
+  std::uint64_t search_ = 0;
+};
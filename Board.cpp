@@ -0,0 +1,202 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "Board.h"
+
+Board::Board() : version_(0) { clear(); }
+
+// ____________________________________________________________________________
+
+void Board::clear() {
+  hash_ = 0;
+  rows_.fill(0);
+  for (auto &row : colors_) {
+    row.fill(0);
+  }
+  heights_.fill(0);
+  filled_ = 0;
+  version_++;
+}
+
+// ____________________________________________________________________________
+
+std::uint64_t Board::rowHash(int y, std::uint16_t mask) {
+  std::uint64_t hash = 0;
+  // Visit the set bits only, lowest first
+  for (; mask != 0; mask &= mask - 1) {
+    hash ^= cellKeys_[y * width_ + __builtin_ctz(mask)];
+  }
+  return hash;
+}
+
+// ____________________________________________________________________________
+
+void Board::updateHeights() {
+  heights_.fill(0);
+  // Go down from the top, the first pixel of a column gives its height
+  std::uint16_t unseen = fullRow_;
+  for (int y = 0; y < height_ && unseen != 0; ++y) {
+    for (std::uint16_t mask = rows_[y] & unseen; mask != 0; mask &= mask - 1) {
+      heights_[__builtin_ctz(mask)] = static_cast<std::uint8_t>(height_ - y);
+    }
+    unseen &= static_cast<std::uint16_t>(~rows_[y]);
+  }
+}
+
+// ____________________________________________________________________________
+
+void Board::set(int x, int y, int color) {
+  colors_[y][x] = static_cast<std::uint8_t>(color);
+  version_++;
+  bool wasFilled = (rows_[y] >> x & 1) != 0;
+  if (wasFilled == (color != 0)) {
+    return;
+  }
+
+  // The occupancy changes: toggle the key and update the column
+  hash_ ^= cellKeys_[y * width_ + x];
+  if (color != 0) {
+    rows_[y] |= static_cast<std::uint16_t>(1 << x);
+    filled_++;
+    heights_[x] = static_cast<std::uint8_t>(
+        std::max<int>(heights_[x], height_ - y));
+  } else {
+    rows_[y] &= static_cast<std::uint16_t>(~(1 << x));
+    filled_--;
+    // Removing the highest pixel of a column lowers it by an unknown amount
+    if (heights_[x] == height_ - y) {
+      updateHeights();
+    }
+  }
+}
+
+// ____________________________________________________________________________
+
+void Board::removeRow(int y) {
+  // Every row up to y changes, take out their keys before and put the keys
+  // of the new rows in after moving
+  for (int row = 0; row <= y; ++row) {
+    hash_ ^= rowHash(row, rows_[row]);
+  }
+
+  // Move every row above y down by one
+  version_++;
+  std::uint16_t removed = rows_[y];
+  for (int row = y; row > 0; --row) {
+    rows_[row] = rows_[row - 1];
+    colors_[row] = colors_[row - 1];
+  }
+  rows_[0] = 0;
+  colors_[0].fill(0);
+
+  for (int row = 1; row <= y; ++row) {
+    hash_ ^= rowHash(row, rows_[row]);
+  }
+  filled_ -= __builtin_popcount(removed);
+  updateHeights();
+}
+
+// ____________________________________________________________________________
+
+bool Board::collides(const TetrominoShape &shape, int x, int y) const {
+  // Check if out of bounds on the left, right, top or bottom side. The
+  // bounding box of every shape is tight, so checking it is enough
+  if (x < 0 || x + shape.width > width_ || y < 0 ||
+      y + shape.height > height_) {
+    return true;
+  }
+
+  for (int row = 0; row < shape.height; ++row) {
+    // Check if the row mask shifted to its column collides with existing
+    // blocks
+    if (overlaps(y + row, shape.rows[row] << x)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// ____________________________________________________________________________
+
+int Board::dropY(const TetrominoShape &shape, int x, int y,
+                 int landing) const {
+  if (landing >= y) {
+    return landing;
+  }
+
+  // The shape is below the surface (tucked under an overhang), move it down
+  // row by row
+  while (!collides(shape, x, y + 1)) {
+    y++;
+  }
+  return y;
+}
+
+// ____________________________________________________________________________
+
+void Board::place(const TetrominoShape &shape, int x, int y, int color) {
+  for (int row = 0; row < shape.height; ++row) {
+    for (int col = 0; col < shape.width; ++col) {
+      if (shape.rows[row] & (1 << col)) {
+        set(x + col, y + row, color);
+      }
+    }
+  }
+}
+
+// ____________________________________________________________________________
+
+int Board::clearFullLines(std::uint32_t &clearedRows) {
+  clearedRows = 0;
+  for (int y = 0; y < height_; ++y) {
+    if (isRowFull(y)) {
+      clearedRows |= 1u << y;
+    }
+  }
+  if (clearedRows == 0) {
+    return 0;
+  }
+
+  version_++;
+
+  // Rows below the lowest full row stay where they are, every row from it
+  // up changes. Take out their keys before and put them in again after
+  int lowest = 31 - __builtin_clz(clearedRows);
+  for (int row = 0; row <= lowest; ++row) {
+    hash_ ^= rowHash(row, rows_[row]);
+  }
+
+  // Copy every row which is not full to the lowest free row, bottom up. A
+  // row is only overwritten after it was read
+  int target = lowest;
+  for (int row = lowest; row >= 0; --row) {
+    if (!isRowFull(row)) {
+      if (target != row) {
+        rows_[target] = rows_[row];
+        colors_[target] = colors_[row];
+      }
+      target--;
+    }
+  }
+  for (; target >= 0; --target) {
+    rows_[target] = 0;
+    colors_[target].fill(0);
+  }
+
+  for (int row = 0; row <= lowest; ++row) {
+    hash_ ^= rowHash(row, rows_[row]);
+  }
+
+  // A column can lose more than the removed rows if a hole was below them
+  int count = __builtin_popcount(clearedRows);
+  filled_ -= count * width_;
+  updateHeights();
+  return count;
+}
+
+// ____________________________________________________________________________
+
+int Board::clearFullLines() {
+  std::uint32_t clearedRows;
+  return clearFullLines(clearedRows);
+}
@@ -0,0 +1,140 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#pragma once
+
+#include "Tetromino.h"
+#include "Zobrist.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+// The playing field as a bitboard: every row is a 16-bit occupancy mask (bit x
+// set means column x is occupied) plus a separate color plane which is only
+// needed for rendering. Collision and full-row tests only touch the masks.
+// A Zobrist hash of the occupancy, the column heights and the number of
+// pixels are kept up to date by every change.
+class Board {
+public:
+  // Dimensions of the board
+  static constexpr int width_ = 10;
+  static constexpr int height_ = 20;
+
+  // Mask of a completely filled row
+  static constexpr std::uint16_t fullRow_ = (1 << width_) - 1;
+
+  // Create an empty board
+  Board();
+
+  // Remove all pixels
+  void clear();
+
+  // Get the color at the given position, 0 means empty
+  int get(int x, int y) const { return colors_[y][x]; }
+
+  // Set the color at the given position, 0 clears the pixel
+  void set(int x, int y, int color);
+
+  // Return the occupancy mask of a row
+  std::uint16_t rowMask(int y) const { return rows_[y]; }
+
+  // Return the Zobrist hash of the occupancy, colors don't change it. Equal
+  // occupancies have equal hashes, whichever way they came about.
+  std::uint64_t getHash() const { return hash_; }
+
+  // Return the occupancy masks of all rows
+  const std::array<std::uint16_t, height_> &rowMasks() const { return rows_; }
+
+  // Return the height of column x: the rows from its highest pixel down to
+  // the floor, 0 if it is empty
+  int getColumnHeight(int x) const { return heights_[x]; }
+
+  // Return the number of empty pixels with a pixel above them in the same
+  // column
+  int getHoles() const {
+    int aggregateHeight = 0;
+    for (std::uint8_t height : heights_) {
+      aggregateHeight += height;
+    }
+    return aggregateHeight - filled_;
+  }
+
+  // Check if a row is completely filled/empty
+  bool isRowFull(int y) const { return rows_[y] == fullRow_; }
+  bool isRowEmpty(int y) const { return rows_[y] == 0; }
+
+  // Check if the given mask (already shifted to its column) overlaps with
+  // the pixels of row y
+  bool overlaps(int y, std::uint16_t mask) const {
+    return (rows_[y] & mask) != 0;
+  }
+
+  // Remove row y and move all rows above it down by one. The top row becomes
+  // empty.
+  void removeRow(int y);
+
+  // Check if the shape at the given position is out of bounds or collides
+  // with existing pixels
+  bool collides(const TetrominoShape &shape, int x, int y) const;
+
+  // Return the y where the shape lands when it falls onto the surface in
+  // column x: one of its bottom pixels right above the highest pixel of a
+  // column. Only looks at the column heights, overhangs are ignored.
+  int landingY(const TetrominoShape &shape, int x) const {
+    int landing = height_;
+    for (int col = 0; col < shape.width; ++col) {
+      landing = std::min(landing,
+                         height_ - heights_[x + col] - 1 - shape.bottom[col]);
+    }
+    return landing;
+  }
+
+  // Return the lowest y the shape falls to when it is dropped straight down
+  // from (x, y), which must not collide. `landing` is landingY(shape, x),
+  // which is the answer if the shape starts above the surface.
+  int dropY(const TetrominoShape &shape, int x, int y, int landing) const;
+  int dropY(const TetrominoShape &shape, int x, int y) const {
+    return dropY(shape, x, y, landingY(shape, x));
+  }
+
+  // Return a number which changes with every change of the board. Copies
+  // start with the number of the original.
+  std::uint32_t getVersion() const { return version_; }
+
+  // Add the pixels of the shape at the given position in the given color
+  void place(const TetrominoShape &shape, int x, int y, int color);
+
+  // Remove all full rows in one pass: the other rows move down in place to
+  // close the gaps and empty rows appear at the top. Return how many rows
+  // were removed, `clearedRows` gets bit y set for every removed row y (in
+  // the numbering before the removal).
+  int clearFullLines(std::uint32_t &clearedRows);
+  int clearFullLines();
+
+private:
+  // Recompute the column heights from the row masks
+  void updateHeights();
+
+  // XOR of the keys of the cells in `mask` in row y
+  static std::uint64_t rowHash(int y, std::uint16_t mask);
+
+  // Zobrist key per cell, indexed by y * width_ + x
+  static constexpr std::array<std::uint64_t, width_ * height_> cellKeys_ =
+      zobristKeys<width_ * height_>(0xB0A2D);
+
+  // Occupancy mask per row
+  std::array<std::uint16_t, height_> rows_;
+
+  // Color per pixel
+  std::array<std::array<std::uint8_t, width_>, height_> colors_;
+
+  // XOR of the keys of all occupied cells
+  std::uint64_t hash_;
+
+  // Incremented by every change
+  std::uint32_t version_;
+
+  // Height per column and number of occupied pixels
+  std::array<std::uint8_t, width_> heights_;
+  int filled_;
+};
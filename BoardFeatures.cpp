@@ -0,0 +1,251 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "BoardFeatures.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TETRIS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Mask of the row bits of the board plus both walls, bit 0 is the left wall
+constexpr std::uint32_t wallRow = 1 | 1 << (Board::width_ + 1);
+constexpr std::uint32_t transitionMask = (1 << (Board::width_ + 1)) - 1;
+
+// Everything that follows from the column masks (bit y set means row y of
+// the column is filled), the number of filled pixels and the row transitions
+void finishFeatures(const std::uint32_t *columns, int filled,
+                    int rowTransitions, BoardFeatures &features) {
+  // The lowest set bit is the highest pixel of a column
+  features.aggregateHeight = 0;
+  for (int x = 0; x < Board::width_; ++x) {
+    int height =
+        columns[x] == 0 ? 0 : Board::height_ - __builtin_ctz(columns[x]);
+    features.heights[x] = height;
+    features.aggregateHeight += height;
+  }
+  // Every pixel below the highest one of its column is filled or a hole
+  features.holes = features.aggregateHeight - filled;
+
+  features.bumpiness = 0;
+  features.wells = 0;
+  for (int x = 0; x < Board::width_; ++x) {
+    int left = x > 0 ? features.heights[x - 1] : Board::height_;
+    int right =
+        x + 1 < Board::width_ ? features.heights[x + 1] : Board::height_;
+    features.wells += std::max(0, std::min(left, right) - features.heights[x]);
+    if (x + 1 < Board::width_) {
+      features.bumpiness += std::abs(features.heights[x] - right);
+    }
+  }
+  features.rowTransitions = rowTransitions;
+}
+
+// ____________________________________________________________________________
+
+// Reference implementation, pixel by pixel
+void computeScalar(const Board &board, BoardFeatures &features) {
+  std::uint32_t columns[Board::width_] = {};
+  int filled = 0;
+  int rowTransitions = 0;
+  for (int y = 0; y < Board::height_; ++y) {
+    bool previous = true;
+    for (int x = 0; x < Board::width_; ++x) {
+      bool pixel = (board.rowMask(y) >> x & 1) != 0;
+      if (pixel) {
+        columns[x] |= 1u << y;
+        filled++;
+      }
+      rowTransitions += pixel != previous;
+      previous = pixel;
+    }
+    rowTransitions += !previous;
+  }
+  finishFeatures(columns, filled, rowTransitions, features);
+}
+
+#ifdef TETRIS_X86
+
+// ____________________________________________________________________________
+
+// Sum of the set bits of all 16-bit lanes (SWAR popcount, SSE2 has no
+// instruction for it)
+__attribute__((target("sse2"))) int popcountLanes(__m128i v) {
+  const __m128i m1 = _mm_set1_epi8(0x55);
+  const __m128i m2 = _mm_set1_epi8(0x33);
+  const __m128i m4 = _mm_set1_epi8(0x0f);
+  v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi16(v, 1), m1));
+  v = _mm_add_epi8(_mm_and_si128(v, m2),
+                   _mm_and_si128(_mm_srli_epi16(v, 2), m2));
+  v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi16(v, 4)), m4);
+  // Add up the bytes of each half
+  v = _mm_sad_epu8(v, _mm_setzero_si128());
+  return _mm_cvtsi128_si32(v) + _mm_extract_epi16(v, 4);
+}
+
+// ____________________________________________________________________________
+
+// Changes between empty and filled pixels of the rows in v, with walls
+__attribute__((target("sse2"))) int transitionsSSE2(__m128i v) {
+  __m128i row = _mm_or_si128(_mm_slli_epi16(v, 1), _mm_set1_epi16(wallRow));
+  __m128i changes = _mm_and_si128(_mm_xor_si128(row, _mm_srli_epi16(row, 1)),
+                                  _mm_set1_epi16(transitionMask));
+  return popcountLanes(changes);
+}
+
+// ____________________________________________________________________________
+
+__attribute__((target("sse2"))) void computeSSE2(const Board &board,
+                                                 BoardFeatures &features) {
+  // Rows 0-7, 8-15 and 16-19, the missing rows of the last vector are empty
+  const std::uint16_t *rows = board.rowMasks().data();
+  __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows));
+  __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows + 8));
+  __m128i v2 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(rows + 16));
+
+  // Transpose: move bit x of every row to the sign bit, widen it to the lane
+  // and pack the lanes to bytes, whose sign bits movemask collects
+  std::uint32_t columns[Board::width_];
+  for (int x = 0; x < Board::width_; ++x) {
+    __m128i shift = _mm_cvtsi32_si128(15 - x);
+    __m128i a = _mm_srai_epi16(_mm_sll_epi16(v0, shift), 15);
+    __m128i b = _mm_srai_epi16(_mm_sll_epi16(v1, shift), 15);
+    __m128i c = _mm_srai_epi16(_mm_sll_epi16(v2, shift), 15);
+    columns[x] = static_cast<std::uint32_t>(
+                     _mm_movemask_epi8(_mm_packs_epi16(a, b))) |
+                 static_cast<std::uint32_t>(_mm_movemask_epi8(
+                     _mm_packs_epi16(c, _mm_setzero_si128())))
+                     << 16;
+  }
+
+  int filled = popcountLanes(v0) + popcountLanes(v1) + popcountLanes(v2);
+  // The 4 missing rows of v2 are empty and have 2 transitions each
+  int rowTransitions =
+      transitionsSSE2(v0) + transitionsSSE2(v1) + transitionsSSE2(v2) - 8;
+  finishFeatures(columns, filled, rowTransitions, features);
+}
+
+// ____________________________________________________________________________
+
+// Sum of the set bits of all lanes, with a lookup table per nibble
+__attribute__((target("avx2"))) int popcountAVX2(__m256i v) {
+  const __m256i lookup =
+      _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1,
+                       2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  __m256i counts = _mm256_add_epi8(
+      _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, nibble)),
+      _mm256_shuffle_epi8(lookup,
+                          _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble)));
+  // Add up the bytes of each quarter
+  __m256i sums = _mm256_sad_epu8(counts, _mm256_setzero_si256());
+  return static_cast<int>(
+      _mm256_extract_epi64(sums, 0) + _mm256_extract_epi64(sums, 1) +
+      _mm256_extract_epi64(sums, 2) + _mm256_extract_epi64(sums, 3));
+}
+
+// ____________________________________________________________________________
+
+// Changes between empty and filled pixels of the rows in v, with walls
+__attribute__((target("avx2"))) __m256i transitionsAVX2(__m256i v) {
+  __m256i row =
+      _mm256_or_si256(_mm256_slli_epi16(v, 1), _mm256_set1_epi16(wallRow));
+  return _mm256_and_si256(_mm256_xor_si256(row, _mm256_srli_epi16(row, 1)),
+                          _mm256_set1_epi16(transitionMask));
+}
+
+// ____________________________________________________________________________
+
+__attribute__((target("avx2,bmi2"))) void computeAVX2(const Board &board,
+                                                      BoardFeatures &features) {
+  // Rows 0-15 and 16-19
+  const std::uint16_t *rows = board.rowMasks().data();
+  __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rows));
+  __m128i v1 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(rows + 16));
+
+  // Transpose: move bit x of every row to the top of its lane, movemask
+  // collects the top bit of every byte and pext keeps the ones of the high
+  // bytes
+  std::uint32_t columns[Board::width_];
+  for (int x = 0; x < Board::width_; ++x) {
+    __m128i shift = _mm_cvtsi32_si128(15 - x);
+    std::uint32_t low = _mm256_movemask_epi8(_mm256_sll_epi16(v0, shift));
+    std::uint32_t high = _mm_movemask_epi8(_mm_sll_epi16(v1, shift));
+    columns[x] = _pext_u32(low, 0xaaaaaaaa) | _pext_u32(high, 0xaa) << 16;
+  }
+
+  // Rows 16-19 in a full vector, the lanes after them are empty
+  __m256i v2 = _mm256_inserti128_si256(_mm256_setzero_si256(), v1, 0);
+  int filled = popcountAVX2(v0) + popcountAVX2(v2);
+
+  // Row transitions, the 12 lanes after row 19 are empty rows with 2
+  // transitions each
+  int rowTransitions =
+      popcountAVX2(transitionsAVX2(v0)) + popcountAVX2(transitionsAVX2(v2)) -
+      2 * 12;
+  finishFeatures(columns, filled, rowTransitions, features);
+}
+
+#endif
+
+// Function of the best backend, chosen once
+using ComputeFunction = void (*)(const Board &, BoardFeatures &);
+
+ComputeFunction functionOf(FeatureBackend backend) {
+#ifdef TETRIS_X86
+  if (backend == FeatureBackend::AVX2) {
+    return computeAVX2;
+  }
+  if (backend == FeatureBackend::SSE2) {
+    return computeSSE2;
+  }
+#endif
+  (void)backend;
+  return computeScalar;
+}
+
+} // namespace
+
+// ____________________________________________________________________________
+
+bool isSupported(FeatureBackend backend) {
+#ifdef TETRIS_X86
+  if (backend == FeatureBackend::AVX2) {
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2");
+  }
+  if (backend == FeatureBackend::SSE2) {
+    return __builtin_cpu_supports("sse2");
+  }
+#endif
+  return backend == FeatureBackend::Scalar;
+}
+
+// ____________________________________________________________________________
+
+FeatureBackend bestFeatureBackend() {
+  for (FeatureBackend backend : {FeatureBackend::AVX2, FeatureBackend::SSE2}) {
+    if (isSupported(backend)) {
+      return backend;
+    }
+  }
+  return FeatureBackend::Scalar;
+}
+
+// ____________________________________________________________________________
+
+void computeFeatures(const Board &board, BoardFeatures &features,
+                     FeatureBackend backend) {
+  functionOf(backend)(board, features);
+}
+
+// ____________________________________________________________________________
+
+void computeFeatures(const Board &board, BoardFeatures &features) {
+  static const ComputeFunction best = functionOf(bestFeatureBackend());
+  best(board, features);
+}
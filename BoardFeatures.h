@@ -0,0 +1,51 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#pragma once
+
+#include "Board.h"
+#include <array>
+
+// Features of a board which evaluation heuristics are built from
+struct BoardFeatures {
+  // Height of every column: rows from the highest pixel to the floor
+  std::array<int, Board::width_> heights;
+  // Sum of the heights
+  int aggregateHeight;
+  // Empty pixels with a pixel somewhere above them in the same column
+  int holes;
+  // Sum of the height differences of neighbouring columns
+  int bumpiness;
+  // Sum of the well depths: how far each column is below both of its
+  // neighbours, walls count as full columns
+  int wells;
+  // Changes between empty and filled pixels along each row, the walls count
+  // as filled
+  int rowTransitions;
+
+  bool operator==(const BoardFeatures &other) const {
+    return heights == other.heights &&
+           aggregateHeight == other.aggregateHeight && holes == other.holes &&
+           bumpiness == other.bumpiness && wells == other.wells &&
+           rowTransitions == other.rowTransitions;
+  }
+};
+
+// Implementations of the feature extraction. Scalar looks at every pixel and
+// is the reference, the SIMD ones transpose the row masks into column masks
+// with vector instructions and count with bit operations.
+enum class FeatureBackend { Scalar, SSE2, AVX2 };
+
+// Check if the CPU can run the given backend
+bool isSupported(FeatureBackend backend);
+
+// The fastest backend the CPU can run
+FeatureBackend bestFeatureBackend();
+
+// Compute the features of the board with the given backend, which must be
+// supported.
+void computeFeatures(const Board &board, BoardFeatures &features,
+                     FeatureBackend backend);
+
+// Compute the features of the board with the best backend
+void computeFeatures(const Board &board, BoardFeatures &features);
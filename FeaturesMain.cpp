@@ -0,0 +1,102 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "AutoPlayer.h"
+#include "BoardFeatures.h"
+#include "Game.h"
+#include "RenderSink.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Collect boards of self-played games, so the benchmark sees realistic
+// stacks instead of noise
+static std::vector<Board> collectBoards(int count) {
+  std::vector<Board> boards;
+  NullRenderSink renderSink;
+  AutoPlayer autoPlayer(1);
+  for (std::uint64_t seed = 1; static_cast<int>(boards.size()) < count;
+       ++seed) {
+    Game game(renderSink, seed);
+    while (!game.isStopped() && static_cast<int>(boards.size()) < count &&
+           autoPlayer.playMove(game, 1)) {
+      game.tick();
+      boards.push_back(game.getBoard());
+    }
+  }
+  return boards;
+}
+
+// Microbenchmark of the feature extraction backends against the scalar
+// reference
+int main(int argc, char *argv[]) {
+  int numBoards = 4096;
+  int rounds = 200;
+
+  // Parsing command line arguments
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    try {
+      if (arg == "--boards" && i + 1 < argc) {
+        numBoards = std::stoi(argv[++i]);
+      } else if (arg == "--rounds" && i + 1 < argc) {
+        rounds = std::stoi(argv[++i]);
+      } else {
+        throw std::invalid_argument(arg);
+      }
+    } catch (std::exception &e) {
+      std::cerr << "Usage: " << argv[0] << " [--boards <n>] [--rounds <n>]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<Board> boards = collectBoards(numBoards);
+  std::vector<BoardFeatures> expected(boards.size());
+  for (std::size_t i = 0; i < boards.size(); ++i) {
+    computeFeatures(boards[i], expected[i], FeatureBackend::Scalar);
+  }
+
+  const char *names[] = {"scalar", "sse2", "avx2"};
+  double scalarTime = 0;
+  for (FeatureBackend backend : {FeatureBackend::Scalar, FeatureBackend::SSE2,
+                                 FeatureBackend::AVX2}) {
+    const char *name = names[static_cast<int>(backend)];
+    if (!isSupported(backend)) {
+      std::cout << name << ": not supported" << std::endl;
+      continue;
+    }
+
+    // The checksum keeps the compiler from dropping the work
+    BoardFeatures features;
+    long checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+      for (const Board &board : boards) {
+        computeFeatures(board, features, backend);
+        checksum += features.holes + features.rowTransitions;
+      }
+    }
+    std::chrono::duration<double> seconds =
+        std::chrono::steady_clock::now() - start;
+
+    int mismatches = 0;
+    for (std::size_t i = 0; i < boards.size(); ++i) {
+      computeFeatures(boards[i], features, backend);
+      mismatches += !(features == expected[i]);
+    }
+
+    double nanoseconds = seconds.count() * 1e9 / (rounds * boards.size());
+    if (backend == FeatureBackend::Scalar) {
+      scalarTime = nanoseconds;
+    }
+    std::cout << name << ": " << nanoseconds << " ns/board, "
+              << scalarTime / nanoseconds << "x scalar, " << mismatches
+              << " mismatches, checksum " << checksum << std::endl;
+    if (mismatches != 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
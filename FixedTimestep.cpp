@@ -0,0 +1,46 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "FixedTimestep.h"
+#include <algorithm>
+
+FixedTimestep::FixedTimestep(int ticksPerSecond, int maxCatchUpTicks)
+    : maxCatchUpTicks_(maxCatchUpTicks) {
+  // The tick duration divides the elapsed time, it must not become 0
+  ticksPerSecond = std::clamp(ticksPerSecond, 1, maxTicksPerSecond_);
+  tickDuration_ = std::max(
+      Clock::duration(1),
+      std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(1)) /
+          ticksPerSecond);
+  nextTick_ = Clock::now();
+  frameStart_ = nextTick_;
+}
+
+// ____________________________________________________________________________
+
+int FixedTimestep::beginFrame(Clock::time_point now) {
+  frameStart_ = now;
+
+  // Count the ticks which are due, the schedule itself only depends on the
+  // start time, so it does not drift
+  int ticks = 0;
+  while (nextTick_ <= now && ticks < maxCatchUpTicks_) {
+    nextTick_ += tickDuration_;
+    ticks++;
+  }
+
+  // Too far behind (e.g. the process was suspended): skip the rest instead of
+  // running an endless catch up
+  if (nextTick_ <= now) {
+    long behind = (now - nextTick_) / tickDuration_ + 1;
+    droppedTicks_ += behind;
+    nextTick_ += behind * tickDuration_;
+  }
+  return ticks;
+}
+
+// ____________________________________________________________________________
+
+void FixedTimestep::endFrame(Clock::time_point now) {
+  budgetUsed_ = static_cast<int>(100 * (now - frameStart_) / tickDuration_);
+}
@@ -0,0 +1,50 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#pragma once
+
+#include <chrono>
+
+// Schedules game logic ticks at a fixed rate on a monotonic clock. The time
+// spent on logic and rendering does not delay the following ticks: ticks
+// which are due are reported all at once, so they can be caught up.
+class FixedTimestep {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Highest rate with ticks of at least one nanosecond
+  static constexpr int maxTicksPerSecond_ = 1000000000;
+
+  // Create a schedule with the given number of ticks per second. At most
+  // `maxCatchUpTicks` ticks are reported per frame, if the game falls behind
+  // further the remaining ticks are dropped. Rates outside of 1 to
+  // maxTicksPerSecond_ are clamped to that range.
+  FixedTimestep(int ticksPerSecond, int maxCatchUpTicks = 8);
+
+  // Start a frame and return the number of ticks which are due until `now`.
+  int beginFrame(Clock::time_point now = Clock::now());
+
+  // End a frame, measuring how much of a tick the frame used.
+  void endFrame(Clock::time_point now = Clock::now());
+
+  // Return the point in time when the next tick is due.
+  Clock::time_point nextTick() const { return nextTick_; }
+
+  // Return the length of a tick.
+  Clock::duration tickDuration() const { return tickDuration_; }
+
+  // Return the share of the tick duration the last frame needed in percent.
+  int budgetUsed() const { return budgetUsed_; }
+
+  // Return the number of ticks that were dropped because the game fell
+  // behind too far.
+  long droppedTicks() const { return droppedTicks_; }
+
+private:
+  Clock::duration tickDuration_;
+  int maxCatchUpTicks_;
+  Clock::time_point nextTick_;
+  Clock::time_point frameStart_;
+  int budgetUsed_ = 0;
+  long droppedTicks_ = 0;
+};
@@ -0,0 +1,74 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "FrameBuffer.h"
+
+FrameBuffer::FrameBuffer(int numRows, int numCols)
+    : numRows_(numRows), numCharCols_(2 * numCols),
+      cells_(numRows * 2 * numCols) {}
+
+// ____________________________________________________________________________
+
+void FrameBuffer::clear() { clear(Cell()); }
+
+// ____________________________________________________________________________
+
+void FrameBuffer::clear(const Cell &value) {
+  for (Cell &c : cells_) {
+    c = value;
+  }
+}
+
+// ____________________________________________________________________________
+
+void FrameBuffer::setCell(int row, int charCol, const Cell &value) {
+  if (row < 0 || row >= numRows_ || charCol < 0 || charCol >= numCharCols_) {
+    return;
+  }
+  cells_[row * numCharCols_ + charCol] = value;
+}
+
+// ____________________________________________________________________________
+
+void FrameBuffer::drawPixel(int col, int row, int color) {
+  Cell value{' ', static_cast<std::uint8_t>(color), true};
+  setCell(row, 2 * col, value);
+  setCell(row, 2 * col + 1, value);
+}
+
+// ____________________________________________________________________________
+
+void FrameBuffer::drawPixelRun(int col, int row, int length, int color) {
+  Cell value{' ', static_cast<std::uint8_t>(color), true};
+  for (int charCol = 2 * col; charCol < 2 * (col + length); ++charCol) {
+    setCell(row, charCol, value);
+  }
+}
+
+// ____________________________________________________________________________
+
+void FrameBuffer::drawString(int row, int col, int color, const char *str) {
+  for (int i = 0; str[i] != '\0'; ++i) {
+    setCell(row, 2 * col + i, Cell{str[i], static_cast<std::uint8_t>(color)});
+  }
+}
+
+// ____________________________________________________________________________
+
+int FrameBuffer::pixelAt(int col, int row) const {
+  if (row < 0 || row >= numRows_ || col < 0 || 2 * col >= numCharCols_) {
+    return -1;
+  }
+  const Cell &c = cell(row, 2 * col);
+  return c.pixel ? c.color : -1;
+}
+
+// ____________________________________________________________________________
+
+std::string FrameBuffer::textAt(int row, int col, int length) const {
+  std::string result;
+  for (int i = 0; i < length && 2 * col + i < numCharCols_; ++i) {
+    result += cell(row, 2 * col + i).ch;
+  }
+  return result;
+}
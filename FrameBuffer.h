@@ -0,0 +1,107 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#pragma once
+
+#include "RenderSink.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Render sink which draws into memory instead of a terminal. The buffer has
+// the same layout as the terminal: every logical column is two characters
+// wide, pixels fill both characters, strings one character each.
+class FrameBuffer : public RenderSink {
+public:
+  // One character of the buffer
+  struct Cell {
+    char ch = ' ';
+    std::uint8_t color = 0;
+    // True if the cell belongs to a pixel (drawn in reverse)
+    bool pixel = false;
+
+    bool operator==(const Cell &other) const {
+      return ch == other.ch && color == other.color && pixel == other.pixel;
+    }
+    bool operator!=(const Cell &other) const { return !(*this == other); }
+  };
+
+  // Create an empty buffer with the given logical dimensions.
+  FrameBuffer(int numRows = 24, int numCols = 40);
+
+  void drawPixel(int col, int row, int color) override;
+  void drawPixelRun(int col, int row, int length, int color) override;
+  void drawString(int row, int col, int color, const char *str) override;
+  void refresh() override { numFrames_++; }
+
+  // Reset every cell to an empty character or to the given value.
+  void clear();
+  void clear(const Cell &value);
+
+  // Compare with the previously shown frame and call
+  // emit(row, charCol, cell, text, length) for every run of changed cells
+  // in a row which share the color and pixel flag of `cell`. `text` holds the
+  // `length` characters of the run. Afterwards `previous` equals this buffer.
+  // Both buffers must have the same dimensions. Return the number of runs.
+  template <typename Emit> int diff(FrameBuffer &previous, Emit emit) const {
+    int numRuns = 0;
+    std::string text;
+    for (int row = 0; row < numRows_; ++row) {
+      std::size_t rowStart = row * numCharCols_;
+      int charCol = 0;
+      while (charCol < numCharCols_) {
+        if (cells_[rowStart + charCol] == previous.cells_[rowStart + charCol]) {
+          charCol++;
+          continue;
+        }
+        // Extend the run as long as the cells changed and look the same
+        const Cell &first = cells_[rowStart + charCol];
+        int end = charCol;
+        text.clear();
+        while (end < numCharCols_) {
+          const Cell &c = cells_[rowStart + end];
+          if (c == previous.cells_[rowStart + end] || c.color != first.color ||
+              c.pixel != first.pixel) {
+            break;
+          }
+          text += c.ch;
+          previous.cells_[rowStart + end] = c;
+          end++;
+        }
+        emit(row, charCol, first, text.c_str(), end - charCol);
+        numRuns++;
+        charCol = end;
+      }
+    }
+    return numRuns;
+  }
+
+  // Return the color of the pixel at the given logical position, -1 if there
+  // is no pixel.
+  int pixelAt(int col, int row) const;
+
+  // Return the characters of the given row, starting at the given logical
+  // column.
+  std::string textAt(int row, int col, int length) const;
+
+  // Access a single character cell.
+  const Cell &cell(int row, int charCol) const {
+    return cells_[row * numCharCols_ + charCol];
+  }
+
+  // Return the logical dimensions of the buffer.
+  int numRows() const { return numRows_; }
+  int numCols() const { return numCharCols_ / 2; }
+
+  // Return how often refresh was called.
+  int numFrames() const { return numFrames_; }
+
+private:
+  // Write a single cell, ignoring positions outside of the buffer.
+  void setCell(int row, int charCol, const Cell &value);
+
+  int numRows_;
+  int numCharCols_;
+  int numFrames_ = 0;
+  std::vector<Cell> cells_;
+};
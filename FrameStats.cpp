@@ -0,0 +1,115 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "FrameStats.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+std::array<LatencyHistogram, numFrameSections> histograms;
+
+std::atomic<bool> timersEnabled{false};
+
+} // namespace
+
+// ____________________________________________________________________________
+
+int LatencyHistogram::bucketOf(std::uint64_t nanoseconds) {
+  if (nanoseconds < 8) {
+    return static_cast<int>(nanoseconds);
+  }
+  if (nanoseconds >> 32 != 0) {
+    return numBuckets_ - 1;
+  }
+  // The highest bit selects the power of two, the 3 bits after it the step
+  int exponent = 63 - __builtin_clzll(nanoseconds);
+  return 8 * (exponent - 2) +
+         static_cast<int>((nanoseconds >> (exponent - 3)) & 7);
+}
+
+// ____________________________________________________________________________
+
+std::uint64_t LatencyHistogram::bucketStart(int bucket) {
+  if (bucket < 8) {
+    return static_cast<std::uint64_t>(bucket);
+  }
+  int exponent = bucket / 8 + 2;
+  return static_cast<std::uint64_t>(8 + bucket % 8) << (exponent - 3);
+}
+
+// ____________________________________________________________________________
+
+std::uint64_t LatencyHistogram::percentile(double share) const {
+  // Sum the buckets instead of using count_, which may be ahead of them
+  // while other threads record
+  std::array<std::uint64_t, numBuckets_> counts;
+  std::uint64_t total = 0;
+  for (int i = 0; i < numBuckets_; ++i) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  std::uint64_t rank = std::max<std::uint64_t>(
+      1, static_cast<std::uint64_t>(std::ceil(share * total)));
+  std::uint64_t seen = 0;
+  for (int i = 0; i < numBuckets_ - 1; ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return std::min(bucketStart(i + 1) - 1, max());
+    }
+  }
+  return max();
+}
+
+// ____________________________________________________________________________
+
+void LatencyHistogram::reset() {
+  for (auto &bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+// ____________________________________________________________________________
+
+const char *sectionName(FrameSection section) {
+  static const char *names[numFrameSections] = {
+      "update", "clean", "board", "ghost", "lines", "refresh"};
+  return names[static_cast<int>(section)];
+}
+
+// ____________________________________________________________________________
+
+LatencyHistogram &sectionHistogram(FrameSection section) {
+  return histograms[static_cast<int>(section)];
+}
+
+// ____________________________________________________________________________
+
+void setSectionTimersEnabled(bool enabled) {
+  timersEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+// ____________________________________________________________________________
+
+bool sectionTimersEnabled() {
+  return timersEnabled.load(std::memory_order_relaxed);
+}
+
+// ____________________________________________________________________________
+
+void writeSectionStats(std::ostream &out) {
+  out << "section count p50_ns p99_ns max_ns\n";
+  for (int i = 0; i < numFrameSections; ++i) {
+    FrameSection section = static_cast<FrameSection>(i);
+    const LatencyHistogram &histogram = sectionHistogram(section);
+    out << sectionName(section) << " " << histogram.count() << " "
+        << histogram.percentile(0.5) << " " << histogram.percentile(0.99)
+        << " " << histogram.max() << "\n";
+  }
+}
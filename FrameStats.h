@@ -0,0 +1,115 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// A histogram of durations in nanoseconds which many threads can record into
+// at the same time without locks. The buckets grow exponentially with 8
+// linear steps per power of two, so percentiles are exact to 12.5%.
+// Durations from about 4 seconds on share the last bucket.
+class LatencyHistogram {
+public:
+  LatencyHistogram() { reset(); }
+
+  LatencyHistogram(const LatencyHistogram &) = delete;
+  LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+  // Add a duration.
+  void record(std::uint64_t nanoseconds) {
+    buckets_[bucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    std::uint64_t max = max_.load(std::memory_order_relaxed);
+    while (nanoseconds > max &&
+           !max_.compare_exchange_weak(max, nanoseconds,
+                                       std::memory_order_relaxed)) {
+    }
+  }
+
+  // Return the duration which the given share (0 to 1) of the recorded ones
+  // doesn't exceed, as the upper end of its bucket. 0 if nothing was
+  // recorded.
+  std::uint64_t percentile(double share) const;
+
+  // Return the number of recorded durations and the longest one.
+  std::uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  std::uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+  // Remove all durations. Must not run at the same time as record.
+  void reset();
+
+  // Return the bucket of a duration and the smallest duration in a bucket.
+  static int bucketOf(std::uint64_t nanoseconds);
+  static std::uint64_t bucketStart(int bucket);
+
+  // Number of buckets: 8 for 0-7 ns, then 8 per power of two up to 2^32 ns
+  static constexpr int numBuckets_ = 8 + 8 * 29;
+
+private:
+  std::array<std::atomic<std::uint64_t>, numBuckets_> buckets_;
+  std::atomic<std::uint64_t> count_;
+  std::atomic<std::uint64_t> max_;
+};
+
+// Parts of a frame which are timed
+enum class FrameSection {
+  Update,
+  Clean,
+  DrawBoard,
+  GhostPiece,
+  ClearLines,
+  Refresh
+};
+
+constexpr int numFrameSections = 6;
+
+// Return the short name of a section.
+const char *sectionName(FrameSection section);
+
+// Return the histogram of a section, shared by all threads.
+LatencyHistogram &sectionHistogram(FrameSection section);
+
+// Turn the section timers on or off, they are off at the start so headless
+// games don't pay for them.
+void setSectionTimersEnabled(bool enabled);
+bool sectionTimersEnabled();
+
+// Write count, p50, p99 and max of every section in nanoseconds, one section
+// per line.
+void writeSectionStats(std::ostream &out);
+
+// Measures the time from its construction to the end of its scope and adds
+// it to the histogram of a section, if the timers are enabled.
+class ScopedTimer {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit ScopedTimer(FrameSection section)
+      : section_(section), enabled_(sectionTimersEnabled()) {
+    if (enabled_) {
+      start_ = Clock::now();
+    }
+  }
+
+  ~ScopedTimer() {
+    if (enabled_) {
+      sectionHistogram(section_).record(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                               start_)
+              .count());
+    }
+  }
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+  FrameSection section_;
+  bool enabled_;
+  Clock::time_point start_;
+};
@@ -2,45 +2,120 @@
 // Ü11 - Uni Freiburg
 
 #include "Game.h"
+#include "FrameStats.h"
 #include <algorithm>
 #include <chrono>
-#include <ctime>
+#include <cstdio>
 #include <iostream>
 #include <string>
 
-Game::Game(TerminalManager &terminalManager) {
+// Seed from the current time for games without a fixed seed
+static std::uint64_t clockSeed() {
+  return std::chrono::high_resolution_clock::now().time_since_epoch().count();
+}
+
+// ____________________________________________________________________________
+
+Game::Game(RenderSink &renderSink) : Game(renderSink, clockSeed()) {}
+
+// ____________________________________________________________________________
+
+Game::Game(RenderSink &renderSink, std::uint64_t seed, RandomizerMode mode)
+    : pieceQueue_(mode, seed) {
   tetrisCount_ = 0;
+  linesCleared_ = 0;
+  clearedRows_ = 0;
+  piecesPlaced_ = 0;
   mdTetromino_ = 48;
+  frameCount_ = 0;
   currentLevel_ = 0;
+  tickCount_ = 0;
+  recorder_ = nullptr;
+  clearLandingCache();
   paused_ = false;
   gameStop_ = false;
   score_ = 0;
+  frameBudget_ = -1;
+  showStats_ = false;
+  statsDrawn_ = false;
 
   // Create the default board and draw the border
-  board_ = std::vector<std::vector<int>>(20, std::vector<int>(10, cleanColor_));
-  drawBorder(terminalManager);
+  board_.clear();
+  drawBorder(renderSink);
 
   // Set random seed and tetromino type
-  srand(std::chrono::high_resolution_clock::now().time_since_epoch().count());
-  nextTetromino_.reset(static_cast<TetrominoType>(rand() % 6));
+  seed_ = seed;
+  nextTetromino_.reset(pieceQueue_.pop());
 
   spawnTetromino();
 }
 
-void Game::update(TerminalManager &terminalManager) {
-  clean(terminalManager); // Clean board/nextPiece
+// ____________________________________________________________________________
 
-  increaseLevel();
+void Game::saveState(GameState &state) const {
+  state.board = board_;
+  state.currentTetromino = currentTetromino_;
+  state.nextTetromino = nextTetromino_;
+  state.tetrominoX = tetrominoX_;
+  state.tetrominoY = tetrominoY_;
+  state.pieceQueue = pieceQueue_;
+  state.seed = seed_;
+  state.tetrisCount = tetrisCount_;
+  state.linesCleared = linesCleared_;
+  state.clearedRows = clearedRows_;
+  state.piecesPlaced = piecesPlaced_;
+  state.mdTetromino = mdTetromino_;
+  state.frameCount = frameCount_;
+  state.currentLevel = currentLevel_;
+  state.tickCount = tickCount_;
+  state.score = score_;
+  state.paused = paused_;
+  state.gameStop = gameStop_;
+}
+
+// ____________________________________________________________________________
 
-  setGhostPiece(terminalManager); // Set/Draw the ghost piece
+void Game::restoreState(const GameState &state) {
+  board_ = state.board;
+  currentTetromino_ = state.currentTetromino;
+  nextTetromino_ = state.nextTetromino;
+  tetrominoX_ = state.tetrominoX;
+  tetrominoY_ = state.tetrominoY;
+  pieceQueue_ = state.pieceQueue;
+  seed_ = state.seed;
+  tetrisCount_ = state.tetrisCount;
+  linesCleared_ = state.linesCleared;
+  clearedRows_ = state.clearedRows;
+  piecesPlaced_ = state.piecesPlaced;
+  mdTetromino_ = state.mdTetromino;
+  frameCount_ = state.frameCount;
+  currentLevel_ = state.currentLevel;
+  tickCount_ = state.tickCount;
+  score_ = state.score;
+  paused_ = state.paused;
+  gameStop_ = state.gameStop;
+
+  // The restored board can have the version of another board
+  clearLandingCache();
+}
+
+// ____________________________________________________________________________
 
-  drawTetromino(terminalManager);
+void Game::tick() {
+  tickCount_++;
 
-  drawInfoPanel(terminalManager);
+  if (paused_ || gameStop_) {
+    return;
+  }
 
-  drawBoard(terminalManager);
+  increaseLevel();
 
-  terminalManager.refresh(); // Refresh the terminal manager
+  // Check if the frameCount is greater then the move down event integer
+  frameCount_++;
+  if (mdTetromino_ < frameCount_) {
+    moveDown();
+    frameCount_ = 0;
+  }
 
   if (checkTopOut()) {
     // If theres a top out, set false to stop running
@@ -50,25 +125,43 @@ void Game::update(TerminalManager &terminalManager) {
 
 // ____________________________________________________________________________
 
+void Game::update(RenderSink &renderSink) {
+  ScopedTimer timer(FrameSection::Update);
+
+  clean(renderSink); // Clean board/nextPiece
+
+  setGhostPiece(renderSink); // Set/Draw the ghost piece
+
+  drawTetromino(renderSink);
+
+  drawInfoPanel(renderSink);
+
+  drawBoard(renderSink);
+
+  renderSink.refresh(); // Refresh the render sink
+}
+
+// ____________________________________________________________________________
+
 // #######
 // DRAWING
 // #######
 
 // ____________________________________________________________________________
 
-void Game::drawTetromino(TerminalManager &terminalManager) {
+void Game::drawTetromino(RenderSink &renderSink) {
 
-  // Create a const reference of shape
-  const std::vector<std::vector<int>> &shape = currentTetromino_.getShape();
+  // Get a view of the shape, nothing is copied
+  ShapeView shape = currentTetromino_.getShape();
 
-  // Iterate over the shape reference vector
-  for (std::size_t y = 0; y < shape.size(); ++y) {
-    for (std::size_t x = 0; x < shape[y].size(); ++x) {
+  // Iterate over the shape
+  for (int y = 0; y < shape.height(); ++y) {
+    for (int x = 0; x < shape.width(); ++x) {
       // If the value returns 0, there's no pixel to draw
-      if (shape[y][x] != 0) {
+      if (shape.at(x, y) != 0) {
         // Add the coordinates to the current value in the shape
-        terminalManager.drawPixel(tetrominoX_ + x + borderSize_,
-                                  tetrominoY_ + y, shape[y][x]);
+        renderSink.drawPixel(tetrominoX_ + x + borderSize_, tetrominoY_ + y,
+                             shape.at(x, y));
       }
     }
   }
@@ -76,17 +169,17 @@ void Game::drawTetromino(TerminalManager &terminalManager) {
 
 // ____________________________________________________________________________
 
-void Game::drawGhostPiece(TerminalManager &terminalManager, int ghostY) {
+void Game::drawGhostPiece(RenderSink &renderSink, int ghostY) {
 
-  const std::vector<std::vector<int>> &shape = currentTetromino_.getShape();
+  ShapeView shape = currentTetromino_.getShape();
 
-  for (std::size_t y = 0; y < shape.size(); ++y) {
-    for (std::size_t x = 0; x < shape[y].size(); ++x) {
-      if (shape[y][x] != 0) {
-        // Add the ghost y value to draw at the lowest possible place
-        terminalManager.drawPixel(tetrominoX_ + x + borderSize_, ghostY + y,
-                                  shape[y][x] +
-                                      8); // +8 to differentiate ghost piece
+  for (int y = 0; y < shape.height(); ++y) {
+    for (int x = 0; x < shape.width(); ++x) {
+      if (shape.at(x, y) != 0) {
+        // Add the ghost y value to draw at the lowest possible place, +8 to
+        // differentiate the ghost piece
+        renderSink.drawPixel(tetrominoX_ + x + borderSize_, ghostY + y,
+                             shape.at(x, y) + 8);
       }
     }
   }
@@ -94,78 +187,152 @@ void Game::drawGhostPiece(TerminalManager &terminalManager, int ghostY) {
 
 // ____________________________________________________________________________
 
-void Game::drawInfoPanel(TerminalManager &terminalManager) {
+void Game::drawInfoPanel(RenderSink &renderSink) {
 
   // NEXT PIECE
 
-  const std::vector<std::vector<int>> &shape = nextTetromino_.getShape();
+  ShapeView shape = nextTetromino_.getShape();
+
+  renderSink.drawString(3, 15, 0, "NEXT");
 
-  terminalManager.drawString(3, 15, 0, "NEXT");
+  for (int y = 0; y < shape.height(); ++y) {
+    for (int x = 0; x < shape.width(); ++x) {
+      if (shape.at(x, y) != 0) {
+        renderSink.drawPixel(15 + x, 4 + y, shape.at(x, y));
+      }
+    }
+  }
+
+  // PREVIEW QUEUE
 
-  for (std::size_t y = 0; y < shape.size(); ++y) {
-    for (std::size_t x = 0; x < shape[y].size(); ++x) {
-      if (shape[y][x] != 0) {
-        terminalManager.drawPixel(15 + x, 4 + y, shape[y][x]);
+  renderSink.drawString(3, 20, 0, "QUEUE");
+
+  for (int i = 0; i < previewSize_; ++i) {
+    ShapeView preview = Tetromino(pieceQueue_.peek(i)).getShape();
+    for (int y = 0; y < preview.height(); ++y) {
+      for (int x = 0; x < preview.width(); ++x) {
+        if (preview.at(x, y) != 0) {
+          renderSink.drawPixel(20 + x, 4 + 3 * i + y, preview.at(x, y));
+        }
       }
     }
   }
 
   // CURRENT LEVEL
 
-  terminalManager.drawString(9, 15, 0, "LEVEL");
+  renderSink.drawString(9, 15, 0, "LEVEL");
 
   std::string tc_str = std::to_string(currentLevel_);
   const char *cstr = tc_str.c_str();
-  terminalManager.drawString(10, 15, 0, cstr);
+  renderSink.drawString(10, 15, 0, cstr);
 
   // SCORE
 
-  terminalManager.drawString(14, 15, 0, "SCORE");
+  renderSink.drawString(14, 15, 0, "SCORE");
 
   std::string tc_str2 = std::to_string(score_);
   const char *cstr2 = tc_str2.c_str();
-  terminalManager.drawString(15, 15, 0, cstr2);
+  renderSink.drawString(15, 15, 0, cstr2);
+
+  // FRAME TIME BUDGET
+
+  if (frameBudget_ >= 0) {
+    renderSink.drawString(17, 15, 0, "FRAME");
+
+    // Pad with spaces to overwrite longer old values
+    std::string budget_str = std::to_string(frameBudget_) + "%   ";
+    renderSink.drawString(18, 15, 0, budget_str.c_str());
+  }
+
+  // SECTION TIMES
+
+  drawStats(renderSink);
 }
 
 // ____________________________________________________________________________
 
-void Game::drawBorder(TerminalManager &terminalManager) {
-  for (int y = 0; y < 20 + 1; y++) { // Added +1 for bottom border
-    terminalManager.drawPixel(0, y, borderColor_);
-    terminalManager.drawPixel(11, y, borderColor_);
+void Game::drawStats(RenderSink &renderSink) {
+  const int width = 26;
+  if (!showStats_) {
+    // Hidden stats are drawn as spaces once, to remove what was shown before
+    if (statsDrawn_) {
+      std::string blank(width, ' ');
+      for (int i = 0; i <= numFrameSections; ++i) {
+        renderSink.drawString(3 + i, 26, 0, blank.c_str());
+      }
+      statsDrawn_ = false;
+    }
+    return;
+  }
+
+  char line[64];
+  std::snprintf(line, sizeof(line), "%-8s%6s%6s%6s", "TIME us", "p50", "p99",
+                "max");
+  renderSink.drawString(3, 26, 0, line);
+  for (int i = 0; i < numFrameSections; ++i) {
+    FrameSection section = static_cast<FrameSection>(i);
+    const LatencyHistogram &histogram = sectionHistogram(section);
+    std::snprintf(line, sizeof(line), "%-8s%6.1f%6.1f%6.1f",
+                  sectionName(section), histogram.percentile(0.5) / 1000.0,
+                  histogram.percentile(0.99) / 1000.0,
+                  histogram.max() / 1000.0);
+    renderSink.drawString(4 + i, 26, 0, line);
   }
+  statsDrawn_ = true;
+}
 
-  for (int x = 0; x < 12; x++) {
-    terminalManager.drawPixel(x, 20, borderColor_);
+// ____________________________________________________________________________
+
+void Game::drawBorder(RenderSink &renderSink) {
+  for (int y = 0; y < 20 + 1; y++) { // Added +1 for bottom border
+    renderSink.drawPixel(0, y, borderColor_);
+    renderSink.drawPixel(11, y, borderColor_);
   }
+
+  renderSink.drawPixelRun(0, 20, 12, borderColor_);
 }
 
 // ____________________________________________________________________________
 
-void Game::drawBoard(TerminalManager &terminalManager) {
-  for (std::size_t y = 0; y < board_.size(); ++y) {
-    for (std::size_t x = 0; x < board_[y].size(); ++x) {
-      if (board_[y][x] != 0) {
-        terminalManager.drawPixel(x + borderSize_, y, board_[y][x]);
+void Game::drawBoard(RenderSink &renderSink) {
+  ScopedTimer timer(FrameSection::DrawBoard);
+  for (int y = 0; y < Board::height_; ++y) {
+    // Skip empty rows without looking at the single pixels
+    if (board_.isRowEmpty(y)) {
+      continue;
+    }
+    // Draw neighbouring pixels of the same color as one run
+    int x = 0;
+    while (x < Board::width_) {
+      int color = board_.get(x, y);
+      int end = x + 1;
+      while (end < Board::width_ && board_.get(end, y) == color) {
+        end++;
+      }
+      if (color != 0) {
+        renderSink.drawPixelRun(x + borderSize_, y, end - x, color);
       }
+      x = end;
     }
   }
 }
 
 // ____________________________________________________________________________
 
-void Game::clean(TerminalManager &terminalManager) {
+void Game::clean(RenderSink &renderSink) {
+  ScopedTimer timer(FrameSection::Clean);
+
   // Clean board
   for (int y = 0; y < 20; y++) {
-    for (int x = 1; x < 11; x++) {
-      terminalManager.drawPixel(x, y, cleanColor_);
-    }
+    renderSink.drawPixelRun(1, y, 10, cleanColor_);
   }
   // Clean next
   for (int y = 0; y < 4; ++y) {
-    for (int x = 0; x < 4; ++x) {
-      terminalManager.drawPixel(15 + x, 4 + y, cleanColor_);
-    }
+    renderSink.drawPixelRun(15, 4 + y, 4, cleanColor_);
+  }
+  // Clean preview queue
+  for (int y = 0; y < 3 * previewSize_; ++y) {
+    renderSink.drawPixelRun(20, 4 + y, 4, cleanColor_);
   }
 }
 
@@ -179,33 +346,57 @@ void Game::clean(TerminalManager &terminalManager) {
 
 void Game::handleInput(char input) {
   if (input == 'p') {
-    paused_ = !paused_;
+    applyAction(ReplayAction::Pause);
   } else if (input == 'a') {
-    if (!paused_)
-      moveLeft();
+    applyAction(ReplayAction::MoveLeft);
   } else if (input == 's') {
-    if (!paused_)
-      hardDrop();
+    applyAction(ReplayAction::HardDrop);
   } else if (input == 'd') {
-    if (!paused_)
-      moveRight();
+    applyAction(ReplayAction::MoveRight);
   } else if (input == 'w') {
-    if (!paused_)
-      moveDown();
+    applyAction(ReplayAction::MoveDown);
   } else if (input == rotateLeftKey_) {
-    if (!paused_)
-      rotate(-1);
+    applyAction(ReplayAction::RotateLeft);
   } else if (input == rotate180Key_) {
-    if (!paused_)
-      rotate(2);
+    applyAction(ReplayAction::Rotate180);
   } else if (input == rotateRightKey_) {
-    if (!paused_)
-      rotate(1);
-  } else if (input == 's') {
-    if (!paused_)
-      moveDown();
+    applyAction(ReplayAction::RotateRight);
+  } else if (input == 't') {
+    // Showing the stats only changes the screen, it is not recorded. After
+    // the rotation keys, which may be set to 't' as well.
+    showStats_ = !showStats_;
   } else if (input == 'q') {
+    applyAction(ReplayAction::Quit);
+  }
+}
+
+// ____________________________________________________________________________
+
+void Game::applyAction(ReplayAction action) {
+  if (recorder_ != nullptr) {
+    recorder_->record(tickCount_, action);
+  }
+
+  if (action == ReplayAction::Pause) {
+    paused_ = !paused_;
+  } else if (action == ReplayAction::Quit) {
     gameStop_ = true;
+  } else if (paused_) {
+    return;
+  } else if (action == ReplayAction::MoveLeft) {
+    moveLeft();
+  } else if (action == ReplayAction::HardDrop) {
+    hardDrop();
+  } else if (action == ReplayAction::MoveRight) {
+    moveRight();
+  } else if (action == ReplayAction::MoveDown) {
+    moveDown();
+  } else if (action == ReplayAction::RotateLeft) {
+    rotate(-1);
+  } else if (action == ReplayAction::Rotate180) {
+    rotate(2);
+  } else if (action == ReplayAction::RotateRight) {
+    rotate(1);
   }
 }
 
@@ -230,26 +421,14 @@ void Game::moveDown() {
 // ____________________________________________________________________________
 
 void Game::clearFullLines() {
+  ScopedTimer timer(FrameSection::ClearLines);
 
   // Count how many tetrises are cleared at once in order to set the score
-  int kCount = 0;
-
-  for (std::size_t y = 0; y < board_.size(); ++y) {
-    // Check if the row has no zeros (if it is full)
-    bool isFull = std::none_of(board_[y].begin(), board_[y].end(),
-                               [](int i) { return i == 0; });
-
-    if (isFull) {
-      // Remove the full line
-      board_.erase(board_.begin() + y);
-      // Insert a new empty line at the top of the board
-      board_.insert(board_.begin(), std::vector<int>(10, 0));
-
-      // Add +1 to the tetrisCount_/kCount;
-      tetrisCount_++;
-      kCount++;
-    }
-  }
+  int kCount = board_.clearFullLines(clearedRows_);
+
+  // Add to the tetrisCount_
+  tetrisCount_ += kCount;
+  linesCleared_ += kCount;
 
   setScore(kCount);
 }
@@ -257,96 +436,72 @@ void Game::clearFullLines() {
 // ____________________________________________________________________________
 
 bool Game::checkCollision(int dx, int dy, int rotation) {
-  // Create a const ref with the given rotation
-  const std::vector<std::vector<int>> &shape =
-      currentTetromino_.getShape(rotation);
-
   // Add current coordinates to move direction to get future coordinates
-  int newX = tetrominoX_ + dx;
-  int newY = tetrominoY_ + dy;
-
-  for (std::size_t y = 0; y < shape.size(); ++y) {
-    for (std::size_t x = 0; x < shape[y].size(); ++x) {
-      // If it's a ghost piece return false
-      if (shape[y][x] > 8) {
-        return false;
-      } else if (shape[y][x] != 0) {
-        std::size_t boardX = newX + x;
-        std::size_t boardY = newY + y;
-
-        // Check if out of bounds on the left side
-        if (boardX < 0) {
-          return true;
-        }
-
-        // Check if out of bounds on the right side with offset
-        if (boardX >= board_[0].size()) {
-          return true;
-        }
-
-        // Check if out of bounds on the bottom
-        if (boardY >= board_.size()) {
-          return true;
-        }
-
-        // Check if collides with existing blocks
-        if (board_[boardY][boardX] != 0) {
-          return true;
-        }
-      }
-    }
-  }
-  return false;
+  return board_.collides(currentTetromino_.getMaskShape(rotation),
+                         tetrominoX_ + dx, tetrominoY_ + dy);
 }
 
 // ____________________________________________________________________________
 
 void Game::placeTetromino() {
-  const std::vector<std::vector<int>> &shape = currentTetromino_.getShape();
-  for (std::size_t y = 0; y < shape.size(); ++y) {
-    for (std::size_t x = 0; x < shape[y].size(); ++x) {
-      if (shape[y][x] != 0) {
-        // Add current shape to board_
-        board_[tetrominoY_ + y][tetrominoX_ + x] = shape[y][x];
-      }
-    }
-  }
+  // Add current shape to board_
+  board_.place(currentTetromino_.getMaskShape(), tetrominoX_, tetrominoY_,
+               currentTetromino_.getColor());
+  piecesPlaced_++;
 }
 
 // ____________________________________________________________________________
 
 void Game::spawnTetromino() {
-  // Set random seed by getting the current ms;
-  srand(std::chrono::high_resolution_clock::now().time_since_epoch().count());
-
   // Assign nextTetrmino type to the current one.
   currentTetromino_.reset(nextTetromino_.getType());
 
-  // Assign a new tetromino to nextTetromino.
-  nextTetromino_.reset(static_cast<TetrominoType>(rand() % 7));
-
-  // Assure that that the same type won't appear after another
-  if (nextTetromino_.getType() == currentTetromino_.getType()) {
-    nextTetromino_.reset(static_cast<TetrominoType>(rand() % 7));
-  }
+  // Assign a new tetromino to nextTetromino. The queue already made sure
+  // that the same type won't appear after another in the classic mode.
+  nextTetromino_.reset(pieceQueue_.pop());
 
-  tetrominoX_ = 4; // Starting x position
-  tetrominoY_ = 0; // Starting y position
+  tetrominoX_ = Tetromino::spawnX_; // Starting x position
+  tetrominoY_ = Tetromino::spawnY_; // Starting y position
 }
 
 // ____________________________________________________________________________
 
-void Game::setGhostPiece(TerminalManager &terminalManager) {
-  int ghostY = tetrominoY_;
+void Game::setGhostPiece(RenderSink &renderSink) {
+  ScopedTimer timer(FrameSection::GhostPiece);
 
   // Find the lowest position where the current Tetromino can be placed without
   // collision
-  while (!checkCollision(0, ghostY - tetrominoY_ + 1, 0)) {
-    ghostY++;
-  }
+  int ghostY = dropY();
 
   // Draw the ghost Tetromino at the calculated position
-  drawGhostPiece(terminalManager, ghostY);
+  drawGhostPiece(renderSink, ghostY);
+}
+
+// ____________________________________________________________________________
+
+int Game::dropY() {
+  if (landingVersion_ != board_.getVersion()) {
+    clearLandingCache();
+  }
+  const TetrominoShape &shape = currentTetromino_.getMaskShape();
+  std::int8_t &landing =
+      landing_[static_cast<int>(currentTetromino_.getType())]
+              [currentTetromino_.getRotation()][tetrominoX_];
+  if (landing == noLanding_) {
+    landing = static_cast<std::int8_t>(board_.landingY(shape, tetrominoX_));
+  }
+  return board_.dropY(shape, tetrominoX_, tetrominoY_, landing);
+}
+
+// ____________________________________________________________________________
+
+void Game::clearLandingCache() {
+  for (auto &rotations : landing_) {
+    for (auto &xs : rotations) {
+      xs.fill(noLanding_);
+    }
+  }
+  landingVersion_ = board_.getVersion();
 }
 
 // ____________________________________________________________________________
@@ -419,14 +574,7 @@ void Game::setScore(int k) {
 
 // ____________________________________________________________________________
 
-bool Game::checkTopOut() {
-  for (size_t i = 0; i < board_[0].size(); i++) {
-    if (board_[0][i] != 0) {
-      return true;
-    }
-  }
-  return false;
-}
+bool Game::checkTopOut() { return !board_.isRowEmpty(0); }
 
 // ____________________________________________________________________________
 
@@ -447,21 +595,40 @@ void Game::moveRight() {
 // ____________________________________________________________________________
 
 void Game::hardDrop() {
-  for (int y = tetrominoY_; y < 20; y++) {
-    if (checkCollision(0, 1, 0)) {
-      // Place the Tetromino one row above the collision point
-      placeTetromino();
-      spawnTetromino();
-      clearFullLines();
-      return;
-    }
-    // Move the Tetromino down by one row
-    tetrominoY_++;
+  // Move the Tetromino down as far as it goes and place it there
+  tetrominoY_ = dropY();
+  placeTetromino();
+  spawnTetromino();
+  clearFullLines();
+}
+
+// ____________________________________________________________________________
+
+bool Game::placeAt(const Placement &placement) {
+  if (paused_ || gameStop_) {
+    return false;
+  }
+
+  // Rotation relative to the current one. Like a hard drop, the tetromino
+  // must rest on the floor or the stack, not float.
+  int rotation = placement.rotation - currentTetromino_.getRotation();
+  const TetrominoShape &shape = currentTetromino_.getMaskShape(rotation);
+  if (board_.collides(shape, placement.x, placement.y) ||
+      !board_.collides(shape, placement.x, placement.y + 1)) {
+    return false;
   }
-  // Place the Tetromino if it reaches the bottom without collision
+
+  if (recorder_ != nullptr) {
+    recorder_->record(tickCount_, ReplayAction::Place, placement);
+  }
+
+  currentTetromino_.rotate(rotation);
+  tetrominoX_ = placement.x;
+  tetrominoY_ = placement.y;
   placeTetromino();
   spawnTetromino();
   clearFullLines();
+  return true;
 }
 
 // ____________________________________________________________________________
@@ -2,48 +2,106 @@
 // Ü11 - Uni Freiburg
 
 #pragma once
-#include "TerminalManager.h"
+#include "Board.h"
+#include "MoveGenerator.h"
+#include "PieceQueue.h"
+#include "RenderSink.h"
+#include "Replay.h"
 #include "Tetromino.h"
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <gtest/gtest.h>
+#include <type_traits>
 #include <vector>
 
+// Everything that changes while a game is played, in one fixed-size block
+// without pointers. Copying it is a memcpy, so search, undo and replay
+// keyframes can clone games cheaply. Settings like the rotation keys are
+// not part of it.
+struct GameState {
+  Board board;
+  Tetromino currentTetromino;
+  Tetromino nextTetromino;
+  int tetrominoX;
+  int tetrominoY;
+  PieceQueue pieceQueue;
+  std::uint64_t seed;
+  int tetrisCount;
+  int linesCleared;
+  std::uint32_t clearedRows;
+  int piecesPlaced;
+  int mdTetromino;
+  int frameCount;
+  int currentLevel;
+  std::uint32_t tickCount;
+  int score;
+  bool paused;
+  bool gameStop;
+};
+
+static_assert(std::is_trivially_copyable_v<GameState>);
+
 // Handles Tetris Logic
 class Game {
 public:
-  // Initialize Game
-  Game(TerminalManager &terminalManager);
+  // Initialize Game, the tetrominos are random with a seed from the clock
+  Game(RenderSink &renderSink);
+
+  // Initialize Game with a fixed seed, the same seed gives the same
+  // tetrominos. The mode selects how the tetromino types are chosen.
+  Game(RenderSink &renderSink, std::uint64_t seed,
+       RandomizerMode mode = RandomizerMode::Classic);
+
+  // Advance the game logic by one fixed timestep: level, gravity and top out
+  void tick();
 
   // Update/refresh screen
-  void update(TerminalManager &terminalManager);
+  void update(RenderSink &renderSink);
 
   // Drawing ------------------------------------
 
   // Draw tetrminos
-  void drawTetromino(TerminalManager &terminalManager);
+  void drawTetromino(RenderSink &renderSink);
 
   // Draw ghost tetrominos
-  void drawGhostPiece(TerminalManager &terminalManager, int ghostY);
+  void drawGhostPiece(RenderSink &renderSink, int ghostY);
 
   // Draw the info panel right next to the playing board
   // The info panel includes:
   // Next piece, level, score
-  void drawInfoPanel(TerminalManager &terminalManager);
+  void drawInfoPanel(RenderSink &renderSink);
+
+  // Draw p50/p99/max of the frame section times to the right of the info
+  // panel if they are shown, else clear that area once after hiding them
+  void drawStats(RenderSink &renderSink);
 
   // Draw the border
-  void drawBorder(TerminalManager &terminalManager);
+  void drawBorder(RenderSink &renderSink);
 
   // Draw the board
-  void drawBoard(TerminalManager &terminalManager);
+  void drawBoard(RenderSink &renderSink);
 
   // Clean the inside of the border and next piece
-  void clean(TerminalManager &terminalManager);
+  void clean(RenderSink &renderSink);
 
   // Input --------------------------------------
 
   // Handle input
   void handleInput(char input);
 
+  // Do what an input key stands for. Recorded if a recorder is set.
+  void applyAction(ReplayAction action);
+
+  // Copy the whole state of the game into `state`/set it from `state`. The
+  // renderer, recorder and keys stay as they are.
+  void saveState(GameState &state) const;
+  void restoreState(const GameState &state);
+
+  // Record every action from now on into the given replay, nullptr stops
+  // recording. The replay has to outlive the game or the recording.
+  void setRecorder(Replay *recorder) { recorder_ = recorder; };
+
   // Tetromino down
   // Public for main
   void moveDown();
@@ -57,6 +115,47 @@ public:
   // Get current mdTetromino int
   int mdTetromino() const { return mdTetromino_; };
 
+  // Get the number of ticks since the start, the clock of replays
+  std::uint32_t getTickCount() const { return tickCount_; };
+
+  // Get a Zobrist hash of the board and the current tetromino (type,
+  // rotation and position)
+  std::uint64_t getHash() const {
+    return board_.getHash() ^
+           PieceKeys::get(currentTetromino_.getType(),
+                          currentTetromino_.getRotation(), tetrominoX_,
+                          tetrominoY_);
+  };
+
+  // Get the seed of the tetromino sequence
+  std::uint64_t getSeed() const { return seed_; };
+
+  // Get statistics of the game
+  int getScore() const { return score_; };
+  int getLevel() const { return currentLevel_; };
+  int getLinesCleared() const { return linesCleared_; };
+  int getPiecesPlaced() const { return piecesPlaced_; };
+
+  // Get the rows removed by the last placed tetromino, bit y is row y as it
+  // was before the removal. 0 if no row was full.
+  std::uint32_t getClearedRows() const { return clearedRows_; };
+
+  // Get the board and the types of the current/next tetromino
+  const Board &getBoard() const { return board_; };
+  TetrominoType getCurrentType() const { return currentTetromino_.getType(); };
+  TetrominoType getNextType() const { return nextTetromino_.getType(); };
+
+  // Get the i-th upcoming type: 0 is the next tetromino, the others come from
+  // the preview queue. `i` must be at most PieceQueue::maxPreview_.
+  TetrominoType getUpcomingType(int i) const {
+    return i == 0 ? nextTetromino_.getType() : pieceQueue_.peek(i - 1);
+  };
+
+  // Move the current tetromino to the given placement and lock it there, like
+  // a hard drop. Used by the autoplayer. Return false if it doesn't fit or
+  // doesn't rest on the floor or the stack.
+  bool placeAt(const Placement &placement);
+
   // --------------------------------------------
 
   // Increase score by 1
@@ -65,6 +164,10 @@ public:
   // Set level/keys
   void setLevel(int n) { currentLevel_ = n; };
 
+  // Set the share of the frame time budget the last frame used, shown in the
+  // info panel. A negative value hides it.
+  void setFrameBudget(int percent) { frameBudget_ = percent; };
+
   void setRotationKeys(char rotateLeft, char rotate180, char rotateRight) {
     rotateLeftKey_ = rotateLeft;
     rotate180Key_ = rotate180;
@@ -80,14 +183,21 @@ private:
   // Check collision for tetrominos with border/tetrominos
   bool checkCollision(int dx, int dy, int rotation);
 
-  // Place a tetromino in game board vector
+  // Place a tetromino in game board
   void placeTetromino();
 
   // Spawn a tetromino
   void spawnTetromino();
 
   // Helper function to set for drawGhostPiece
-  void setGhostPiece(TerminalManager &terminalManager);
+  void setGhostPiece(RenderSink &renderSink);
+
+  // Return the lowest y the current tetromino falls to. Where it lands on
+  // the surface is cached per type, rotation and x until the board changes.
+  int dropY();
+
+  // Forget all cached landing rows
+  void clearLandingCache();
 
   // Check if the speed should increase according to the level
   void checkLevel();
@@ -121,7 +231,7 @@ private:
   // Game board ---------------------------------
 
   // Representing the game board
-  std::vector<std::vector<int>> board_;
+  Board board_;
 
   // Border Size to shift the game logic
   static const int borderSize_ = 1;
@@ -138,18 +248,48 @@ private:
   // Current position of tetromino
   int tetrominoX_, tetrominoY_;
 
+  // Upcoming tetromino types and the seed of their random generator
+  PieceQueue pieceQueue_;
+  std::uint64_t seed_;
+
+  // Number of upcoming tetrominos shown after the next one
+  static const int previewSize_ = 3;
+
   // Level up -----------------------------------
 
   // Amount of line clears
   int tetrisCount_;
 
+  // Amount of line clears and placed tetrominos in the whole game
+  int linesCleared_;
+  int piecesPlaced_;
+
+  // Rows removed by the last placed tetromino
+  std::uint32_t clearedRows_;
+
   // Amount of frames when tetromino should move down
   // Level 0 speed = 48ms
   int mdTetromino_;
 
+  // Count the frames to know wether a tetromino should move down
+  int frameCount_;
+
   // Current level.
   int currentLevel_;
 
+  // Number of calls to tick, also while paused
+  std::uint32_t tickCount_;
+
+  // Replay which records the actions, if any
+  Replay *recorder_;
+
+  // Landing rows (Board::landingY) per type, rotation and x for the board
+  // with version landingVersion_, noLanding_ if not computed yet
+  static constexpr std::int8_t noLanding_ = -128;
+  std::array<std::array<std::array<std::int8_t, Board::width_>, 4>, 7>
+      landing_;
+  std::uint32_t landingVersion_;
+
   // --------------------------------------------
 
   // Default color to clean the screen
@@ -164,6 +304,14 @@ private:
   // Game score
   int score_;
 
+  // Frame time budget used by the last frame in percent
+  int frameBudget_;
+
+  // Show the section times next to the info panel, toggled with 't'
+  bool showStats_;
+  // The section times are on the screen and have to be cleared when hidden
+  bool statsDrawn_;
+
   // Rotation keys
   char rotateLeftKey_;
   char rotate180Key_;
@@ -186,4 +334,13 @@ private:
   FRIEND_TEST(Game, HardDrop);
   FRIEND_TEST(Game, Rotate);
   FRIEND_TEST(Game, TogglePause);
+  FRIEND_TEST(Game, UpdateFrameBuffer);
+  FRIEND_TEST(Game, Tick);
+  FRIEND_TEST(Game, PlaceAt);
+  FRIEND_TEST(Game, Seed);
+  FRIEND_TEST(Game, SevenBag);
+  FRIEND_TEST(Game, Replay);
+
+  // The benchmarks in TetrisBench.cpp time the private helpers as well
+  friend struct GameBenchAccess;
 };
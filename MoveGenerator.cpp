@@ -0,0 +1,122 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "MoveGenerator.h"
+#include <array>
+#include <cstdint>
+
+// The search works on whole rows at once: for every rotation and row there is
+// a mask of the x positions where the tetromino fits, and a mask of the x
+// positions which are reachable. Tetrominos never move up, so the rows can
+// be handled from top to bottom.
+
+namespace {
+
+// Masks per rotation and row, bit x stands for the tetromino at column x
+using RowMasks = std::array<std::array<std::uint16_t, Board::height_>, 4>;
+
+// Compute where the shape fits in each row. Rows where the shape would stick
+// out at the bottom stay 0.
+void computeFits(const Board &board, const TetrominoShape &shape,
+                 std::array<std::uint16_t, Board::height_> &fits) {
+  fits.fill(0);
+  // Every x where the bounding box stays inside the board
+  std::uint16_t inside = (1 << (Board::width_ - shape.width + 1)) - 1;
+  for (int y = 0; y + shape.height <= Board::height_; ++y) {
+    // A pixel of the shape at column col collides at x if the board has a
+    // pixel at x + col, so shift the board row right by col
+    std::uint16_t blocked = 0;
+    for (int row = 0; row < shape.height; ++row) {
+      std::uint16_t boardRow = board.rowMask(y + row);
+      for (int col = 0; col < shape.width; ++col) {
+        if (shape.rows[row] & (1 << col)) {
+          blocked |= boardRow >> col;
+        }
+      }
+    }
+    fits[y] = inside & ~blocked;
+  }
+}
+
+// Extend the reachable positions in a row by moving left and right as long
+// as the tetromino fits
+std::uint16_t spread(std::uint16_t reach, std::uint16_t fits) {
+  std::uint16_t previous;
+  do {
+    previous = reach;
+    reach = (reach | (reach << 1) | (reach >> 1)) & fits;
+  } while (reach != previous);
+  return reach;
+}
+
+} // namespace
+
+// ____________________________________________________________________________
+
+void generatePlacements(const Board &board, TetrominoType type,
+                        std::vector<Placement> &placements) {
+  placements.clear();
+
+  Tetromino tetromino(type);
+  int numRotations = tetromino.getNumRotations();
+
+  RowMasks fits;
+  RowMasks reach{};
+  for (int r = 0; r < numRotations; ++r) {
+    computeFits(board, tetromino.getMaskShape(r), fits[r]);
+  }
+
+  // Blocked spawn, the game is over
+  std::uint16_t spawn = 1 << Tetromino::spawnX_;
+  if (!(fits[0][Tetromino::spawnY_] & spawn)) {
+    return;
+  }
+  reach[0][Tetromino::spawnY_] = spawn;
+
+  for (int y = Tetromino::spawnY_; y < Board::height_; ++y) {
+    // Move left/right and rotate until nothing new is reachable in this row.
+    // Each rotation can reach every other rotation with a single turn (left,
+    // right or 180°), so it is enough to share the union of all rotations.
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      std::uint16_t any = 0;
+      for (int r = 0; r < numRotations; ++r) {
+        reach[r][y] = spread(reach[r][y], fits[r][y]);
+        any |= reach[r][y];
+      }
+      for (int r = 0; r < numRotations; ++r) {
+        std::uint16_t rotated = (reach[r][y] | any) & fits[r][y];
+        if (rotated != reach[r][y]) {
+          reach[r][y] = rotated;
+          changed = true;
+        }
+      }
+    }
+
+    for (int r = 0; r < numRotations; ++r) {
+      // Moving down is possible where the tetromino fits one row further
+      std::uint16_t below = y + 1 < Board::height_ ? fits[r][y + 1] : 0;
+      if (y + 1 < Board::height_) {
+        reach[r][y + 1] |= reach[r][y] & below;
+      }
+
+      // Final placements are the reachable ones which can't move down
+      std::uint16_t locked = reach[r][y] & ~below;
+      for (int x = 0; locked != 0; ++x, locked >>= 1) {
+        if (locked & 1) {
+          placements.push_back(Placement{r, x, y});
+        }
+      }
+    }
+  }
+}
+
+// ____________________________________________________________________________
+
+std::vector<Placement> generatePlacements(const Board &board,
+                                          TetrominoType type) {
+  std::vector<Placement> placements;
+  generatePlacements(board, type, placements);
+  return placements;
+}
@@ -0,0 +1,34 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#pragma once
+
+#include "Board.h"
+#include "Tetromino.h"
+#include <vector>
+
+// A final position of a tetromino: the rotation index and the position of the
+// top left corner of its bounding box, as in Game.
+struct Placement {
+  int rotation;
+  int x;
+  int y;
+
+  bool operator==(const Placement &other) const {
+    return rotation == other.rotation && x == other.x && y == other.y;
+  }
+};
+
+// Enumerate every distinct final placement a tetromino of the given type can
+// reach from its spawn position with the moves of the game (left, right,
+// down and the rotations without kicks). A placement is final if the
+// tetromino can't move down from it. Symmetric rotations are not in the
+// rotation table, so every placement covers a different set of pixels. The
+// placements are written to `placements`, which is cleared first. If the
+// spawn position is blocked, there is no placement.
+void generatePlacements(const Board &board, TetrominoType type,
+                        std::vector<Placement> &placements);
+
+// Same as above, returning a new vector.
+std::vector<Placement> generatePlacements(const Board &board,
+                                          TetrominoType type);
@@ -0,0 +1,83 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "Perft.h"
+#include "MoveGenerator.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <unordered_set>
+
+namespace {
+
+// The occupancy of a board, colors don't matter for the search
+using BoardKey = std::array<std::uint16_t, Board::height_>;
+
+// Hash of a board key, mixing 64 bits at a time
+struct BoardKeyHash {
+  std::size_t operator()(const BoardKey &key) const {
+    std::uint64_t hash = 0;
+    for (std::size_t i = 0; i < key.size(); i += 4) {
+      std::uint64_t word = 0;
+      std::memcpy(&word, &key[i], sizeof(word));
+      hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+      hash ^= hash >> 29;
+    }
+    return hash;
+  }
+};
+
+// Rebuild a board from its occupancy
+Board toBoard(const BoardKey &key) {
+  Board board;
+  for (int y = 0; y < Board::height_; ++y) {
+    for (int x = 0; key[y] >> x; ++x) {
+      if (key[y] & (1 << x)) {
+        board.set(x, y, 1);
+      }
+    }
+  }
+  return board;
+}
+
+} // namespace
+
+// ____________________________________________________________________________
+
+std::vector<PerftLevel> perft(const Board &board,
+                              const std::vector<TetrominoType> &pieces,
+                              int depth) {
+  std::vector<PerftLevel> levels;
+  std::vector<BoardKey> frontier = {board.rowMasks()};
+  std::vector<Placement> placements;
+
+  for (int d = 0; d < depth && !pieces.empty(); ++d) {
+    Tetromino tetromino(pieces[d % pieces.size()]);
+    std::unordered_set<BoardKey, BoardKeyHash> seen;
+    std::vector<BoardKey> next;
+    long nodes = 0;
+
+    for (const BoardKey &key : frontier) {
+      Board current = toBoard(key);
+      generatePlacements(current, tetromino.getType(), placements);
+      for (const Placement &p : placements) {
+        nodes++;
+        Board child = current;
+        child.place(tetromino.getMaskShape(p.rotation), p.x, p.y,
+                    tetromino.getColor());
+        child.clearFullLines();
+        if (!seen.insert(child.rowMasks()).second) {
+          continue;
+        }
+        // A topped out board ends the game
+        if (child.isRowEmpty(0)) {
+          next.push_back(child.rowMasks());
+        }
+      }
+    }
+
+    levels.push_back(PerftLevel{nodes, static_cast<long>(seen.size())});
+    frontier = std::move(next);
+  }
+  return levels;
+}
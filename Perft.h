@@ -0,0 +1,25 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#pragma once
+
+#include "Board.h"
+#include "Tetromino.h"
+#include <vector>
+
+// Counts of one depth of a perft run
+struct PerftLevel {
+  // Number of placements which were enumerated at this depth
+  long nodes;
+  // Number of distinct boards (by occupancy) after this depth
+  long distinct;
+};
+
+// Starting from `board`, place the pieces of `pieces` one after another in
+// every reachable way (see generatePlacements) and clear full lines after
+// each placement. Boards which are equal after a depth are only expanded
+// once, boards that topped out are counted but not expanded. The sequence is
+// repeated if it is shorter than `depth`. Return the counts of each depth.
+std::vector<PerftLevel> perft(const Board &board,
+                              const std::vector<TetrominoType> &pieces,
+                              int depth);
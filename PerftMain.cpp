@@ -0,0 +1,94 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "Board.h"
+#include "Perft.h"
+#include "Tetromino.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Read a board from a text file: 20 lines of 10 characters, '.' is an empty
+// pixel, everything else a filled one. Return false if the file is invalid.
+static bool readBoard(const std::string &fileName, Board &board) {
+  std::ifstream file(fileName);
+  std::string line;
+  for (int y = 0; y < Board::height_; ++y) {
+    if (!std::getline(file, line) ||
+        line.size() < static_cast<std::size_t>(Board::width_)) {
+      return false;
+    }
+    for (int x = 0; x < Board::width_; ++x) {
+      board.set(x, y, line[x] == '.' ? 0 : 1);
+    }
+  }
+  return true;
+}
+
+// Convert piece letters like "IOT" into types. Return false on an unknown
+// letter.
+static bool parsePieces(const std::string &letters,
+                        std::vector<TetrominoType> &pieces) {
+  const std::string names = "IOTSZJL";
+  pieces.clear();
+  for (char letter : letters) {
+    std::size_t index = names.find(letter);
+    if (index == std::string::npos) {
+      return false;
+    }
+    pieces.push_back(static_cast<TetrominoType>(index));
+  }
+  return !pieces.empty();
+}
+
+int main(int argc, char *argv[]) {
+  int depth = 3;
+  std::vector<TetrominoType> pieces;
+  parsePieces("TIOLJSZ", pieces);
+  Board board;
+
+  // Parsing command line arguments
+  for (int i = 1; i < argc; ++i) {
+    if (std::string(argv[i]) == "--pieces" && i + 1 < argc) {
+      if (!parsePieces(argv[i + 1], pieces)) {
+        std::cerr << "Error: Pieces must be letters of IOTSZJL." << std::endl;
+        return 1;
+      }
+      ++i;
+    } else if (std::string(argv[i]) == "--board" && i + 1 < argc) {
+      if (!readBoard(argv[i + 1], board)) {
+        std::cerr << "Error: Could not read a 10x20 board from " << argv[i + 1]
+                  << std::endl;
+        return 1;
+      }
+      ++i;
+    } else {
+      try {
+        depth = std::stoi(argv[i]);
+      } catch (std::exception &e) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--pieces <letters>] [--board <file>] [depth]"
+                  << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<PerftLevel> levels = perft(board, pieces, depth);
+  std::chrono::duration<double> seconds =
+      std::chrono::steady_clock::now() - start;
+
+  long totalNodes = 0;
+  for (std::size_t d = 0; d < levels.size(); ++d) {
+    std::cout << "depth " << d + 1 << ": nodes " << levels[d].nodes
+              << ", distinct " << levels[d].distinct << std::endl;
+    totalNodes += levels[d].nodes;
+  }
+  std::cout << "total nodes " << totalNodes << " in " << seconds.count()
+            << "s, " << static_cast<long>(totalNodes / seconds.count())
+            << " nodes/s" << std::endl;
+  return 0;
+}
@@ -0,0 +1,55 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "PieceQueue.h"
+#include <utility>
+
+PieceQueue::PieceQueue(RandomizerMode mode, std::uint64_t seed)
+    : mode_(mode), random_(seed) {
+  buffer_.fill(TetrominoType::I);
+  refill();
+  refill();
+}
+
+// ____________________________________________________________________________
+
+TetrominoType PieceQueue::pop() {
+  TetrominoType type = buffer_[head_];
+  head_ = (head_ + 1) % capacity_;
+  size_--;
+  // Keep enough types for the preview
+  if (size_ <= maxPreview_) {
+    refill();
+  }
+  return type;
+}
+
+// ____________________________________________________________________________
+
+void PieceQueue::refill() {
+  std::array<int, 7> types;
+  if (mode_ == RandomizerMode::SevenBag) {
+    // Shuffle a bag of all types (Fisher-Yates)
+    for (int i = 0; i < 7; ++i) {
+      types[i] = i;
+    }
+    for (int i = 6; i > 0; --i) {
+      std::swap(types[i], types[random_.uniform(i + 1)]);
+    }
+  } else {
+    // Assure that that the same type won't appear after another, by rolling
+    // again once
+    for (int &type : types) {
+      type = random_.uniform(7);
+      if (type == last_) {
+        type = random_.uniform(7);
+      }
+      last_ = type;
+    }
+  }
+
+  for (int type : types) {
+    buffer_[(head_ + size_) % capacity_] = static_cast<TetrominoType>(type);
+    size_++;
+  }
+}
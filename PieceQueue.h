@@ -0,0 +1,56 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#pragma once
+
+#include "Random.h"
+#include "Tetromino.h"
+#include <array>
+#include <cstdint>
+
+// How the types of new tetrominos are chosen
+enum class RandomizerMode {
+  // Random type, rolled again once if it repeats the previous type
+  Classic,
+  // Every type once in a random order, then the next bag of 7
+  SevenBag
+};
+
+// The upcoming tetromino types. They are generated ahead of time, 7 at a
+// time, into a ring buffer, so taking the next type is just a pop and the
+// following types can be looked at without using the random generator.
+class PieceQueue {
+public:
+  // Number of types which can always be looked at with `peek`
+  static constexpr int maxPreview_ = 7;
+
+  explicit PieceQueue(RandomizerMode mode = RandomizerMode::Classic,
+                      std::uint64_t seed = 0);
+
+  // Remove and return the next type.
+  TetrominoType pop();
+
+  // Return the i-th upcoming type without removing it, 0 is the type the
+  // next `pop` returns. `i` must be smaller than `maxPreview_`.
+  TetrominoType peek(int i) const {
+    return buffer_[(head_ + i) % capacity_];
+  }
+
+  RandomizerMode getMode() const { return mode_; }
+
+private:
+  // Append 7 new types to the buffer.
+  void refill();
+
+  static constexpr int capacity_ = 16;
+
+  RandomizerMode mode_;
+  Random random_;
+  std::array<TetrominoType, capacity_> buffer_;
+  // Index of the next type and number of types in the buffer
+  int head_ = 0;
+  int size_ = 0;
+  // Last generated type for the repeat check of the classic mode, -1 if
+  // there is none
+  int last_ = -1;
+};
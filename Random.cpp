@@ -0,0 +1,56 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "Random.h"
+
+namespace {
+std::uint64_t rotl(std::uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+} // namespace
+
+// ____________________________________________________________________________
+
+void Random::setSeed(std::uint64_t seed) {
+  // Expand the seed with splitmix64, so similar seeds give unrelated states
+  // and the state is never all zeros
+  for (std::uint64_t &word : state_) {
+    seed += 0x9E3779B97F4A7C15ULL;
+    std::uint64_t z = seed;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    word = z ^ (z >> 31);
+  }
+}
+
+// ____________________________________________________________________________
+
+std::uint64_t Random::next() {
+  std::uint64_t result = rotl(state_[1] * 5, 7) * 9;
+  std::uint64_t t = state_[1] << 17;
+  state_[2] ^= state_[0];
+  state_[3] ^= state_[1];
+  state_[1] ^= state_[2];
+  state_[0] ^= state_[3];
+  state_[2] ^= t;
+  state_[3] = rotl(state_[3], 45);
+  return result;
+}
+
+// ____________________________________________________________________________
+
+int Random::uniform(int bound) {
+  // Lemire's method: scale 32 random bits by multiplication and reject the
+  // few values which would make some results more likely than others
+  std::uint32_t range = static_cast<std::uint32_t>(bound);
+  std::uint64_t m = (next() >> 32) * range;
+  std::uint32_t low = static_cast<std::uint32_t>(m);
+  if (low < range) {
+    std::uint32_t threshold = -range % range;
+    while (low < threshold) {
+      m = (next() >> 32) * range;
+      low = static_cast<std::uint32_t>(m);
+    }
+  }
+  return static_cast<int>(m >> 32);
+}
@@ -0,0 +1,28 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#pragma once
+
+#include <cstdint>
+
+// Small and fast pseudo random number generator (xoshiro256**). Every game
+// owns one, so games can run in parallel and the same seed always gives the
+// same sequence.
+class Random {
+public:
+  // Create a generator with the given seed.
+  explicit Random(std::uint64_t seed = 0) { setSeed(seed); }
+
+  // Restart the sequence with the given seed.
+  void setSeed(std::uint64_t seed);
+
+  // Return the next 64 random bits.
+  std::uint64_t next();
+
+  // Return a uniformly distributed number in [0, bound), without the bias of
+  // `next() % bound`. `bound` must be positive.
+  int uniform(int bound);
+
+private:
+  std::uint64_t state_[4];
+};
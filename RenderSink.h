@@ -0,0 +1,39 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#pragma once
+
+// Everything the game draws goes through this interface. The TerminalManager
+// draws with ncurses, the other implementations allow running the game
+// without a terminal.
+class RenderSink {
+public:
+  virtual ~RenderSink() = default;
+
+  // Draw a pixel at the given logical position in the given color.
+  virtual void drawPixel(int col, int row, int color) = 0;
+
+  // Draw `length` pixels of the same color in a row, starting at the given
+  // logical position. Implementations can draw the whole run at once.
+  virtual void drawPixelRun(int col, int row, int length, int color) {
+    for (int i = 0; i < length; ++i) {
+      drawPixel(col + i, row, color);
+    }
+  }
+
+  // Draw a string at the given logical position and color.
+  virtual void drawString(int row, int col, int color, const char *str) = 0;
+
+  // Show the contents of the screen.
+  virtual void refresh() = 0;
+};
+
+// Render sink which ignores everything, for running the game logic headless
+// at full speed.
+class NullRenderSink : public RenderSink {
+public:
+  void drawPixel(int, int, int) override {}
+  void drawPixelRun(int, int, int, int) override {}
+  void drawString(int, int, int, const char *) override {}
+  void refresh() override {}
+};
@@ -0,0 +1,206 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "Replay.h"
+#include "Game.h"
+#include <cstring>
+#include <fstream>
+
+// Magic bytes and format version at the start of every log
+static const char magic[4] = {'T', 'R', 'P', 'L'};
+static const std::uint8_t version = 1;
+
+// Bits of an event varint used by the action
+static const int actionBits = 4;
+
+// ____________________________________________________________________________
+
+// Append `value` as LEB128 varint: 7 bits per byte, the high bit marks that
+// more bytes follow
+static void writeVarint(std::vector<std::uint8_t> &bytes, std::uint64_t value) {
+  while (value >= 0x80) {
+    bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  bytes.push_back(static_cast<std::uint8_t>(value));
+}
+
+// ____________________________________________________________________________
+
+// Decode a varint at `offset` and move `offset` behind it. Return false if
+// the bytes end in the middle of it.
+static bool readVarint(const std::vector<std::uint8_t> &bytes,
+                       std::size_t &offset, std::uint64_t &value) {
+  value = 0;
+  for (int shift = 0; offset < bytes.size() && shift < 64; shift += 7) {
+    std::uint8_t byte = bytes[offset++];
+    value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// ____________________________________________________________________________
+
+Replay::Replay(std::uint64_t seed, RandomizerMode mode, int startLevel)
+    : seed_(seed), mode_(mode), startLevel_(startLevel) {
+  for (char c : magic) {
+    bytes_.push_back(static_cast<std::uint8_t>(c));
+  }
+  bytes_.push_back(version);
+  bytes_.push_back(static_cast<std::uint8_t>(mode));
+  writeVarint(bytes_, seed);
+  // Zigzag encoding, negative levels are allowed
+  writeVarint(bytes_, static_cast<std::uint32_t>(startLevel) << 1 ^
+                          static_cast<std::uint32_t>(startLevel >> 31));
+  headerSize_ = bytes_.size();
+}
+
+// ____________________________________________________________________________
+
+void Replay::record(std::uint32_t frame, ReplayAction action,
+                    const Placement &placement) {
+  std::uint64_t delta = frame - lastFrame_;
+  writeVarint(bytes_, delta << actionBits | static_cast<std::uint64_t>(action));
+  if (action == ReplayAction::Place) {
+    // x < 16 and y < 32, so rotation, x and y fit in 11 bits
+    writeVarint(bytes_, placement.rotation | placement.x << 2 |
+                            placement.y << 6);
+  }
+  lastFrame_ = frame;
+}
+
+// ____________________________________________________________________________
+
+bool Replay::fromBytes(const std::uint8_t *data, std::size_t size) {
+  if (size < sizeof(magic) + 2 ||
+      std::memcmp(data, magic, sizeof(magic)) != 0 ||
+      data[sizeof(magic)] != version) {
+    return false;
+  }
+  // Only known randomizers, anything else is no replay of this game
+  std::uint8_t mode = data[sizeof(magic) + 1];
+  if (mode != static_cast<std::uint8_t>(RandomizerMode::Classic) &&
+      mode != static_cast<std::uint8_t>(RandomizerMode::SevenBag)) {
+    return false;
+  }
+  bytes_.assign(data, data + size);
+
+  std::size_t offset = sizeof(magic) + 2;
+  mode_ = static_cast<RandomizerMode>(mode);
+  std::uint64_t level;
+  if (!readVarint(bytes_, offset, seed_) ||
+      !readVarint(bytes_, offset, level)) {
+    return false;
+  }
+  startLevel_ = static_cast<int>(level >> 1) ^ -static_cast<int>(level & 1);
+  headerSize_ = offset;
+
+  // Continue recording after the last event
+  lastFrame_ = 0;
+  ReplayEvent event;
+  while (readEvent(offset, lastFrame_, event)) {
+    lastFrame_ = event.frame;
+  }
+  return true;
+}
+
+// ____________________________________________________________________________
+
+bool Replay::save(const std::string &path) const {
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char *>(bytes_.data()), bytes_.size());
+  return static_cast<bool>(file);
+}
+
+// ____________________________________________________________________________
+
+bool Replay::load(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file)),
+                                 std::istreambuf_iterator<char>());
+  return fromBytes(data.data(), data.size());
+}
+
+// ____________________________________________________________________________
+
+bool Replay::readEvent(std::size_t &offset, std::uint32_t frame,
+                       ReplayEvent &event) const {
+  std::uint64_t value;
+  if (!readVarint(bytes_, offset, value)) {
+    return false;
+  }
+  event.frame = frame + static_cast<std::uint32_t>(value >> actionBits);
+  event.action =
+      static_cast<ReplayAction>(value & ((1 << actionBits) - 1));
+  if (event.action == ReplayAction::Place) {
+    if (!readVarint(bytes_, offset, value)) {
+      return false;
+    }
+    event.placement.rotation = value & 3;
+    event.placement.x = (value >> 2) & 15;
+    event.placement.y = (value >> 6) & 31;
+  }
+  return true;
+}
+
+// ____________________________________________________________________________
+
+ReplayPlayer::ReplayPlayer(const Replay &replay)
+    : ReplayPlayer(replay, replay.eventsBegin(), 0) {}
+
+// ____________________________________________________________________________
+
+ReplayPlayer::ReplayPlayer(const Replay &replay, std::size_t offset,
+                           std::uint32_t frame)
+    : replay_(replay), offset_(offset) {
+  next_.frame = frame;
+  readNext();
+}
+
+// ____________________________________________________________________________
+
+void ReplayPlayer::readNext() {
+  eventOffset_ = offset_;
+  eventFrame_ = next_.frame;
+  // A log without an end, e.g. of a crashed game, ends after its last event
+  if (!replay_.readEvent(offset_, next_.frame, next_)) {
+    next_.action = ReplayAction::End;
+  }
+}
+
+// ____________________________________________________________________________
+
+bool ReplayPlayer::step(Game &game) {
+  // Apply the actions in the order they were recorded, then the tick. That
+  // is the order of the main loop.
+  while (!done_ && next_.frame <= game.getTickCount()) {
+    if (next_.action == ReplayAction::End) {
+      done_ = true;
+    } else if (next_.action == ReplayAction::Place) {
+      game.placeAt(next_.placement);
+      readNext();
+    } else {
+      game.applyAction(next_.action);
+      readNext();
+    }
+  }
+  if (done_ || game.isStopped()) {
+    done_ = true;
+    return false;
+  }
+  game.tick();
+  return true;
+}
+
+// ____________________________________________________________________________
+
+void ReplayPlayer::run(Game &game) {
+  while (step(game)) {
+  }
+}
@@ -0,0 +1,132 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#pragma once
+
+#include "MoveGenerator.h"
+#include "PieceQueue.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Game;
+
+// Everything a player (or the autoplayer) can do to a game. Gravity is not an
+// action, it follows from the number of ticks.
+enum class ReplayAction : std::uint8_t {
+  MoveLeft,
+  MoveRight,
+  MoveDown,
+  HardDrop,
+  RotateLeft,
+  Rotate180,
+  RotateRight,
+  Pause,
+  Quit,
+  // Lock the current tetromino at a placement, see Game::placeAt
+  Place,
+  // Last event of a finished recording
+  End
+};
+
+// One recorded action and the tick it happened at
+struct ReplayEvent {
+  std::uint32_t frame = 0;
+  ReplayAction action = ReplayAction::End;
+  // Only used by ReplayAction::Place
+  Placement placement{};
+};
+
+// A recorded game as a compact binary log. The header holds the seed,
+// randomizer mode and start level, which decide everything but the actions.
+// Every event is a varint of the frame delta to the previous event shifted
+// left by 4 plus the action, so most events take a single byte. A placement
+// adds one more varint.
+class Replay {
+public:
+  // An empty replay, to be filled with `load` or `fromBytes`
+  Replay() = default;
+
+  // Start recording a game with the given settings
+  Replay(std::uint64_t seed, RandomizerMode mode, int startLevel);
+
+  // Append an action which happened at the given tick. Frames must not
+  // decrease.
+  void record(std::uint32_t frame, ReplayAction action,
+              const Placement &placement = Placement{});
+
+  // Mark the recording as finished at the given tick
+  void finish(std::uint32_t frame) { record(frame, ReplayAction::End); }
+
+  // Settings of the recorded game
+  std::uint64_t getSeed() const { return seed_; }
+  RandomizerMode getMode() const { return mode_; }
+  int getStartLevel() const { return startLevel_; }
+
+  // The encoded log, header included
+  const std::vector<std::uint8_t> &bytes() const { return bytes_; }
+
+  // Decode a log from the given bytes. Return false if they are no replay.
+  bool fromBytes(const std::uint8_t *data, std::size_t size);
+
+  // Write/read the log to/from a file. Return false on errors.
+  bool save(const std::string &path) const;
+  bool load(const std::string &path);
+
+  // Decode the event at byte `offset` of the log and move `offset` behind it.
+  // `frame` is the frame of the previous event. Return false at the end of
+  // the log.
+  bool readEvent(std::size_t &offset, std::uint32_t frame,
+                 ReplayEvent &event) const;
+
+  // Offset of the first event
+  std::size_t eventsBegin() const { return headerSize_; }
+
+private:
+  std::uint64_t seed_ = 0;
+  RandomizerMode mode_ = RandomizerMode::Classic;
+  int startLevel_ = 0;
+
+  // Frame of the last recorded event
+  std::uint32_t lastFrame_ = 0;
+
+  std::vector<std::uint8_t> bytes_;
+  std::size_t headerSize_ = 0;
+};
+
+// Plays a replay back into a game, one tick at a time. The game has to be
+// created with the seed, mode and start level of the replay.
+class ReplayPlayer {
+public:
+  explicit ReplayPlayer(const Replay &replay);
+
+  // Continue a replay at the event at byte `offset`, `frame` is the frame of
+  // the event before it. The game has to be in the state it had there.
+  ReplayPlayer(const Replay &replay, std::size_t offset, std::uint32_t frame);
+
+  // Apply the actions of the current tick and advance the game by one tick.
+  // Return false once the replay has ended.
+  bool step(Game &game);
+
+  // Play the rest of the replay without any waiting
+  void run(Game &game);
+
+  bool isDone() const { return done_; }
+
+  // Position of the next event which is not applied yet: its byte offset and
+  // the frame of the event before it. Continue there with the constructor.
+  std::size_t eventOffset() const { return eventOffset_; }
+  std::uint32_t eventFrame() const { return eventFrame_; }
+
+private:
+  // Read the next event, an incomplete log ends with its last event
+  void readNext();
+
+  const Replay &replay_;
+  std::size_t offset_;
+  ReplayEvent next_;
+  std::size_t eventOffset_ = 0;
+  std::uint32_t eventFrame_ = 0;
+  bool done_ = false;
+};
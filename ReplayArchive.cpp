@@ -0,0 +1,266 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "ReplayArchive.h"
+#include "Game.h"
+#include "RenderSink.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// Magic bytes and format version at the start of every archive
+static const char magic[4] = {'T', 'R', 'A', 'R'};
+static const std::uint32_t version = 6;
+static const std::size_t headerSize = sizeof(magic) + sizeof(version);
+
+// Keyframes hold the raw bytes of a GameState. A new layout of it is a new
+// format, so bump the version when this fails and update the size.
+static_assert(sizeof(GameState) == 464,
+              "GameState changed, bump the archive version");
+
+// Size of the replay size and keyframe count in front of every record
+static const std::size_t recordHeaderSize = 2 * sizeof(std::uint32_t);
+
+// ____________________________________________________________________________
+
+// Write the bytes of a trivially copyable value
+template <typename T>
+static void writeRaw(std::ofstream &file, const T &value) {
+  file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+// ____________________________________________________________________________
+
+// Read a trivially copyable value from possibly unaligned memory
+template <typename T> static T readRaw(const std::uint8_t *data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+// ____________________________________________________________________________
+
+ReplayArchiveWriter::ReplayArchiveWriter(const std::string &path,
+                                         int keyframeInterval)
+    : keyframeInterval_(std::max(keyframeInterval, 1)) {
+  // Only append to archives of this format, anything else would become
+  // unreadable. Such files stay untouched.
+  std::ifstream existing(path, std::ios::binary);
+  if (existing && existing.peek() != std::ifstream::traits_type::eof()) {
+    char header[headerSize] = {};
+    existing.read(header, headerSize);
+    validHeader_ = existing.good() &&
+                   std::memcmp(header, magic, sizeof(magic)) == 0 &&
+                   readRaw<std::uint32_t>(reinterpret_cast<std::uint8_t *>(
+                       header + sizeof(magic))) == version;
+    if (!validHeader_) {
+      return;
+    }
+  }
+
+  archive_.open(path, std::ios::binary | std::ios::app);
+  index_.open(path + ".idx", std::ios::binary | std::ios::app);
+  archive_.seekp(0, std::ios::end);
+  index_.seekp(0, std::ios::end);
+  if (!isOpen()) {
+    return;
+  }
+
+  end_ = static_cast<std::uint64_t>(archive_.tellp());
+  size_ = static_cast<std::uint64_t>(index_.tellp()) / sizeof(std::uint64_t);
+  if (end_ == 0) {
+    archive_.write(magic, sizeof(magic));
+    writeRaw(archive_, version);
+    end_ = headerSize;
+  }
+}
+
+// ____________________________________________________________________________
+
+bool ReplayArchiveWriter::append(const Replay &replay) {
+  if (!isOpen()) {
+    return false;
+  }
+
+  // Play the game back and take a keyframe at its start and every
+  // keyframeInterval_ tetrominos. A keyframe is taken before the actions of
+  // its tick, where a player can continue.
+  NullRenderSink renderSink;
+  Game game(renderSink, replay.getSeed(), replay.getMode());
+  game.setLevel(replay.getStartLevel());
+  ReplayPlayer player(replay);
+  std::vector<ReplayKeyframe> keyframes;
+  int nextKeyframe = 0;
+  do {
+    if (game.getPiecesPlaced() >= nextKeyframe) {
+      // Zeroed, so the padding bytes in the file are defined
+      ReplayKeyframe keyframe;
+      std::memset(static_cast<void *>(&keyframe), 0, sizeof(keyframe));
+      keyframe.eventOffset = player.eventOffset();
+      keyframe.eventFrame = player.eventFrame();
+      game.saveState(keyframe.state);
+      keyframes.push_back(keyframe);
+      nextKeyframe = game.getPiecesPlaced() + keyframeInterval_;
+    }
+  } while (player.step(game));
+
+  // The record first, so the index never points behind the archive
+  writeRaw(archive_, static_cast<std::uint32_t>(replay.bytes().size()));
+  writeRaw(archive_, static_cast<std::uint32_t>(keyframes.size()));
+  archive_.write(reinterpret_cast<const char *>(keyframes.data()),
+                 keyframes.size() * sizeof(ReplayKeyframe));
+  archive_.write(reinterpret_cast<const char *>(replay.bytes().data()),
+                 replay.bytes().size());
+  archive_.flush();
+
+  writeRaw(index_, end_);
+  index_.flush();
+
+  end_ += recordHeaderSize + keyframes.size() * sizeof(ReplayKeyframe) +
+          replay.bytes().size();
+  size_++;
+  return isOpen();
+}
+
+// ____________________________________________________________________________
+
+// Map a whole file read only. An empty file gives nullptr and size 0. Return
+// false on errors.
+static bool mapFile(const std::string &path, const std::uint8_t *&data,
+                    std::size_t &size) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    ::close(fd);
+    return false;
+  }
+  size = static_cast<std::size_t>(info.st_size);
+  data = nullptr;
+  if (size > 0) {
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+      ::close(fd);
+      return false;
+    }
+    data = static_cast<const std::uint8_t *>(mapped);
+  }
+  // The mapping stays valid without the descriptor
+  ::close(fd);
+  return true;
+}
+
+// ____________________________________________________________________________
+
+ReplayArchive::~ReplayArchive() { close(); }
+
+// ____________________________________________________________________________
+
+void ReplayArchive::close() {
+  if (archive_ != nullptr) {
+    munmap(const_cast<std::uint8_t *>(archive_), archiveSize_);
+  }
+  if (index_ != nullptr) {
+    munmap(const_cast<std::uint8_t *>(index_), indexSize_);
+  }
+  archive_ = index_ = nullptr;
+  archiveSize_ = indexSize_ = size_ = 0;
+}
+
+// ____________________________________________________________________________
+
+bool ReplayArchive::open(const std::string &path) {
+  close();
+  if (!mapFile(path, archive_, archiveSize_) ||
+      !mapFile(path + ".idx", index_, indexSize_) ||
+      archiveSize_ < headerSize ||
+      std::memcmp(archive_, magic, sizeof(magic)) != 0 ||
+      readRaw<std::uint32_t>(archive_ + sizeof(magic)) != version) {
+    close();
+    return false;
+  }
+  size_ = indexSize_ / sizeof(std::uint64_t);
+  return true;
+}
+
+// ____________________________________________________________________________
+
+const std::uint8_t *ReplayArchive::record(std::size_t k) const {
+  if (k >= size_) {
+    return nullptr;
+  }
+  std::uint64_t offset =
+      readRaw<std::uint64_t>(index_ + k * sizeof(std::uint64_t));
+  if (offset < headerSize || offset + recordHeaderSize > archiveSize_) {
+    return nullptr;
+  }
+  return archive_ + offset;
+}
+
+// ____________________________________________________________________________
+
+bool ReplayArchive::replay(std::size_t k, Replay &replay) const {
+  const std::uint8_t *data = record(k);
+  if (data == nullptr) {
+    return false;
+  }
+  std::size_t replaySize = readRaw<std::uint32_t>(data);
+  std::size_t begin = recordHeaderSize +
+                      readRaw<std::uint32_t>(data + sizeof(std::uint32_t)) *
+                          sizeof(ReplayKeyframe);
+  if (static_cast<std::size_t>(data - archive_) + begin + replaySize >
+      archiveSize_) {
+    return false;
+  }
+  return replay.fromBytes(data + begin, replaySize);
+}
+
+// ____________________________________________________________________________
+
+std::size_t ReplayArchive::numKeyframes(std::size_t k) const {
+  const std::uint8_t *data = record(k);
+  if (data == nullptr) {
+    return 0;
+  }
+  std::size_t count = readRaw<std::uint32_t>(data + sizeof(std::uint32_t));
+  // Don't trust a count which reaches behind the archive
+  std::size_t end = static_cast<std::size_t>(data - archive_) +
+                    recordHeaderSize + count * sizeof(ReplayKeyframe);
+  return end <= archiveSize_ ? count : 0;
+}
+
+// ____________________________________________________________________________
+
+ReplayKeyframe ReplayArchive::keyframe(std::size_t k, std::size_t i) const {
+  // numKeyframes also checks that the record and its keyframes are mapped
+  if (i >= numKeyframes(k)) {
+    return ReplayKeyframe();
+  }
+  return readRaw<ReplayKeyframe>(record(k) + recordHeaderSize +
+                                 i * sizeof(ReplayKeyframe));
+}
+
+// ____________________________________________________________________________
+
+std::size_t ReplayArchive::findKeyframe(std::size_t k,
+                                        std::uint32_t piece) const {
+  // Find the first keyframe after `piece`, the one before it is the result
+  std::size_t low = 0;
+  std::size_t high = numKeyframes(k);
+  while (low < high) {
+    std::size_t middle = (low + high) / 2;
+    if (static_cast<std::uint32_t>(keyframe(k, middle).state.piecesPlaced) <=
+        piece) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low == 0 ? 0 : low - 1;
+}
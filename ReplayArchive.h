@@ -0,0 +1,105 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#pragma once
+
+#include "Game.h"
+#include "Replay.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <type_traits>
+
+// Snapshot of a game every few tetrominos of a replay, to continue playing
+// the replay in the middle. Stored as raw bytes in the archive.
+struct ReplayKeyframe {
+  // Position of the next event in the replay, see ReplayPlayer::eventOffset
+  std::uint32_t eventOffset;
+  std::uint32_t eventFrame;
+  // The whole game at the keyframe, see Game::restoreState
+  GameState state;
+};
+
+static_assert(std::is_trivially_copyable<ReplayKeyframe>::value,
+              "Keyframes are written as raw bytes");
+
+// Appends replays to an archive file. An archive is a header followed by one
+// record per game: the replay size, the number of keyframes, the keyframes
+// and the replay. The byte offset of every record goes into a separate index
+// file (<archive>.idx), 8 bytes per game, so readers find game K without
+// looking at the games before it.
+class ReplayArchiveWriter {
+public:
+  // Open the archive for appending, it is created if it doesn't exist.
+  // Every `keyframeInterval` tetrominos of a game get a keyframe.
+  explicit ReplayArchiveWriter(const std::string &path,
+                               int keyframeInterval = 64);
+
+  // Check if the archive could be opened, is an archive of this version and
+  // every write worked
+  bool isOpen() const {
+    return validHeader_ && archive_.good() && index_.good();
+  }
+
+  // Append a finished replay. It is played back once to create the
+  // keyframes. Return false on write errors.
+  bool append(const Replay &replay);
+
+  // Number of games in the archive
+  std::uint64_t size() const { return size_; }
+
+private:
+  std::ofstream archive_;
+  std::ofstream index_;
+  int keyframeInterval_;
+  // The existing file starts with the magic bytes and version of this build
+  bool validHeader_ = true;
+  // End of the archive file, where the next record goes
+  std::uint64_t end_ = 0;
+  std::uint64_t size_ = 0;
+};
+
+// Read only view of an archive. Both files are mapped into memory, so any
+// game and any keyframe can be reached without parsing what comes before.
+class ReplayArchive {
+public:
+  ReplayArchive() = default;
+  ~ReplayArchive();
+
+  ReplayArchive(const ReplayArchive &) = delete;
+  ReplayArchive &operator=(const ReplayArchive &) = delete;
+
+  // Map the archive and its index. Return false if they can't be read or are
+  // no archive.
+  bool open(const std::string &path);
+
+  // Number of games in the archive
+  std::size_t size() const { return size_; }
+
+  // Decode the replay of game k into `replay`. Return false if there is no
+  // game k or its record is broken.
+  bool replay(std::size_t k, Replay &replay) const;
+
+  // Number of keyframes of game k and keyframe i of game k. A missing or
+  // broken game has no keyframes, a keyframe out of range is empty.
+  std::size_t numKeyframes(std::size_t k) const;
+  ReplayKeyframe keyframe(std::size_t k, std::size_t i) const;
+
+  // Index of the last keyframe of game k at or before tetromino `piece`
+  // (binary search). The first keyframe is at the start of the game.
+  std::size_t findKeyframe(std::size_t k, std::uint32_t piece) const;
+
+private:
+  // Start of the record of game k, nullptr if k or its offset is out of range
+  const std::uint8_t *record(std::size_t k) const;
+
+  // Unmap both files
+  void close();
+
+  const std::uint8_t *archive_ = nullptr;
+  std::size_t archiveSize_ = 0;
+  const std::uint8_t *index_ = nullptr;
+  std::size_t indexSize_ = 0;
+  std::size_t size_ = 0;
+};
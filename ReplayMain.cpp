@@ -0,0 +1,166 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "Game.h"
+#include "RenderSink.h"
+#include "Replay.h"
+#include "ReplayArchive.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Totals over all played replays
+struct Totals {
+  long replays = 0;
+  long ticks = 0;
+  long pieces = 0;
+};
+
+// Play a replay back headless as fast as possible and print its result
+static void playReplay(const std::string &name, const Replay &replay,
+                       Totals &totals) {
+  NullRenderSink renderSink;
+  Game game(renderSink, replay.getSeed(), replay.getMode());
+  game.setLevel(replay.getStartLevel());
+  ReplayPlayer(replay).run(game);
+
+  std::cout << name << ": score " << game.getScore() << ", lines "
+            << game.getLinesCleared() << ", level " << game.getLevel()
+            << ", pieces " << game.getPiecesPlaced() << ", ticks "
+            << game.getTickCount() << ", " << replay.bytes().size()
+            << " bytes" << std::endl;
+  totals.replays++;
+  totals.ticks += game.getTickCount();
+  totals.pieces += game.getPiecesPlaced();
+}
+
+// Print the keyframe of game k at or before tetromino `piece` and play the
+// rest of the game from there. Return false if the game has no keyframes.
+static bool playFromKeyframe(const ReplayArchive &archive, std::size_t k,
+                             std::uint32_t piece, Totals &totals) {
+  Replay replay;
+  if (archive.numKeyframes(k) == 0 || !archive.replay(k, replay)) {
+    return false;
+  }
+  ReplayKeyframe keyframe =
+      archive.keyframe(k, archive.findKeyframe(k, piece));
+  const GameState &state = keyframe.state;
+  std::cout << "game " << k << ", keyframe at piece " << state.piecesPlaced
+            << ", tick " << state.tickCount << ": score " << state.score
+            << ", lines " << state.linesCleared << ", level "
+            << state.currentLevel << std::endl;
+  for (std::uint16_t row : state.board.rowMasks()) {
+    for (int x = 0; x < Board::width_; ++x) {
+      std::cout << ((row >> x & 1) != 0 ? '#' : '.');
+    }
+    std::cout << std::endl;
+  }
+
+  // Continue the replay at the keyframe instead of at the start
+  NullRenderSink renderSink;
+  Game game(renderSink, replay.getSeed(), replay.getMode());
+  game.restoreState(state);
+  ReplayPlayer(replay, keyframe.eventOffset, keyframe.eventFrame).run(game);
+  std::cout << "game " << k << ": score " << game.getScore() << ", lines "
+            << game.getLinesCleared() << ", level " << game.getLevel()
+            << ", pieces " << game.getPiecesPlaced() << ", ticks "
+            << game.getTickCount() << std::endl;
+  totals.replays++;
+  totals.ticks += game.getTickCount() - state.tickCount;
+  totals.pieces += game.getPiecesPlaced() - state.piecesPlaced;
+  return true;
+}
+
+// Play recorded games back headless as fast as possible and print their
+// results, to reproduce bug reports and to score archived games again.
+int main(int argc, char *argv[]) {
+  std::vector<std::string> paths;
+  std::string archivePath;
+  long game = -1;
+  long piece = -1;
+
+  // Parsing command line arguments
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    try {
+      if (arg == "--archive" && i + 1 < argc) {
+        archivePath = argv[++i];
+      } else if (arg == "--game" && i + 1 < argc) {
+        game = std::stol(argv[++i]);
+      } else if (arg == "--piece" && i + 1 < argc) {
+        piece = std::stol(argv[++i]);
+      } else if (arg.rfind("--", 0) == 0) {
+        throw std::invalid_argument(arg);
+      } else {
+        paths.push_back(arg);
+      }
+    } catch (std::exception &e) {
+      paths.clear();
+      break;
+    }
+  }
+  if (paths.empty() == archivePath.empty() ||
+      (piece >= 0 && (archivePath.empty() || game < 0))) {
+    std::cerr << "Usage: " << argv[0] << " <replay file>..." << std::endl;
+    std::cerr << "       " << argv[0]
+              << " --archive <file> [--game <k> [--piece <m>]]" << std::endl;
+    return 1;
+  }
+
+  Totals totals;
+  int failed = 0;
+  auto start = std::chrono::steady_clock::now();
+  if (!archivePath.empty()) {
+    ReplayArchive archive;
+    if (!archive.open(archivePath)) {
+      std::cerr << "Error: Could not read archive " << archivePath << "."
+                << std::endl;
+      return 1;
+    }
+
+    // One game or all of them
+    std::size_t first = game >= 0 ? game : 0;
+    std::size_t last = game >= 0 ? game + 1 : archive.size();
+    if (last > archive.size()) {
+      std::cerr << "Error: The archive has only " << archive.size()
+                << " games." << std::endl;
+      return 1;
+    }
+    if (piece >= 0) {
+      if (!playFromKeyframe(archive, first, piece, totals)) {
+        std::cerr << "Error: Game " << first << " has no keyframes."
+                  << std::endl;
+        failed++;
+      }
+    } else {
+      for (std::size_t k = first; k < last; ++k) {
+        Replay replay;
+        if (!archive.replay(k, replay)) {
+          std::cerr << "Error: Game " << k << " is broken." << std::endl;
+          failed++;
+          continue;
+        }
+        playReplay("game " + std::to_string(k), replay, totals);
+      }
+    }
+  } else {
+    for (const std::string &path : paths) {
+      Replay replay;
+      if (!replay.load(path)) {
+        std::cerr << "Error: Could not read replay " << path << "."
+                  << std::endl;
+        failed++;
+        continue;
+      }
+      playReplay(path, replay, totals);
+    }
+  }
+  std::chrono::duration<double> seconds =
+      std::chrono::steady_clock::now() - start;
+
+  std::cout << totals.replays << " replays, " << totals.pieces << " pieces, "
+            << totals.ticks << " ticks in " << seconds.count() << "s"
+            << std::endl;
+  return failed == 0 ? 0 : 1;
+}
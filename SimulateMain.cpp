@@ -0,0 +1,193 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "AutoPlayer.h"
+#include "FrameBuffer.h"
+#include "Game.h"
+#include "RenderSink.h"
+#include "Replay.h"
+#include "ReplayArchive.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Result of one simulated game
+struct GameResult {
+  int score;
+  int linesCleared;
+  int level;
+  int piecesPlaced;
+};
+
+// Play a whole game headless with the autoplayer, as fast as possible. The
+// game ends with a top out or after `maxPieces` tetrominos. The game is
+// recorded into `recording` if given. With `render` every move is drawn into
+// a frame buffer, like TetrisMain draws to the terminal.
+static GameResult playGame(std::uint64_t seed, RandomizerMode mode,
+                           int startLevel, int beamWidth, int lookahead,
+                           int maxPieces, Replay *recording, bool render) {
+  NullRenderSink nullRenderSink;
+  FrameBuffer frameBuffer;
+  RenderSink &renderSink =
+      render ? static_cast<RenderSink &>(frameBuffer) : nullRenderSink;
+  Game game(renderSink, seed, mode);
+  game.setLevel(startLevel);
+  AutoPlayer autoPlayer(beamWidth);
+
+  game.setRecorder(recording);
+
+  while (!game.isStopped() && game.getPiecesPlaced() < maxPieces) {
+    if (!autoPlayer.playMove(game, lookahead)) {
+      break;
+    }
+    // Level up and top out check
+    game.tick();
+    if (render) {
+      game.update(renderSink);
+    }
+  }
+
+  if (recording != nullptr) {
+    recording->finish(game.getTickCount());
+  }
+  return GameResult{game.getScore(), game.getLinesCleared(), game.getLevel(),
+                    game.getPiecesPlaced()};
+}
+
+int main(int argc, char *argv[]) {
+  int numGames = 100;
+  int numThreads = std::thread::hardware_concurrency();
+  int maxPieces = 1000;
+  int beamWidth = 4;
+  int startLevel = 0;
+  int lookahead = 2;
+  RandomizerMode mode = RandomizerMode::Classic;
+  bool perGame = false;
+  bool render = false;
+
+  // Record game i into <recordPrefix>i.rpl and/or append it to an archive
+  std::string recordPrefix;
+  std::string archivePath;
+
+  // Game i uses seed + i
+  std::uint64_t seed =
+      std::chrono::steady_clock::now().time_since_epoch().count();
+
+  // Parsing command line arguments
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    try {
+      if (arg == "--games" && i + 1 < argc) {
+        numGames = std::stoi(argv[++i]);
+      } else if (arg == "--threads" && i + 1 < argc) {
+        numThreads = std::stoi(argv[++i]);
+      } else if (arg == "--max-pieces" && i + 1 < argc) {
+        maxPieces = std::stoi(argv[++i]);
+      } else if (arg == "--beam-width" && i + 1 < argc) {
+        beamWidth = std::stoi(argv[++i]);
+      } else if (arg == "--level" && i + 1 < argc) {
+        startLevel = std::stoi(argv[++i]);
+      } else if (arg == "--seed" && i + 1 < argc) {
+        seed = std::stoull(argv[++i]);
+      } else if (arg == "--lookahead" && i + 1 < argc) {
+        lookahead = std::stoi(argv[++i]);
+      } else if (arg == "--bag") {
+        mode = RandomizerMode::SevenBag;
+      } else if (arg == "--record" && i + 1 < argc) {
+        recordPrefix = argv[++i];
+      } else if (arg == "--archive" && i + 1 < argc) {
+        archivePath = argv[++i];
+      } else if (arg == "--per-game") {
+        perGame = true;
+      } else if (arg == "--render") {
+        render = true;
+      } else {
+        throw std::invalid_argument(arg);
+      }
+    } catch (std::exception &e) {
+      std::cerr << "Usage: " << argv[0]
+                << " [--games <n>] [--threads <n>] [--max-pieces <n>] "
+                   "[--beam-width <n>] [--lookahead <n>] [--level <n>] "
+                   "[--seed <n>] [--bag] [--record <prefix>] "
+                   "[--archive <file>] [--per-game] [--render]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  // Games finish in any order, the archive takes them one at a time
+  std::unique_ptr<ReplayArchiveWriter> archive;
+  std::mutex archiveMutex;
+  if (!archivePath.empty()) {
+    archive = std::make_unique<ReplayArchiveWriter>(archivePath);
+    if (!archive->isOpen()) {
+      std::cerr << "Error: Could not open archive " << archivePath
+                << " or it is no archive of this version." << std::endl;
+      return 1;
+    }
+  }
+
+  // One task per game, the pool balances long and short games
+  std::vector<GameResult> results(std::max(numGames, 0));
+  auto start = std::chrono::steady_clock::now();
+  {
+    ThreadPool threadPool(numThreads);
+    threadPool.parallelFor(numGames, [&](int i) {
+      bool record = !recordPrefix.empty() || archive != nullptr;
+      Replay recording(seed + i, mode, startLevel);
+      results[i] = playGame(seed + i, mode, startLevel, beamWidth, lookahead,
+                            maxPieces, record ? &recording : nullptr, render);
+
+      std::string recordPath = recordPrefix + std::to_string(i) + ".rpl";
+      if (!recordPrefix.empty() && !recording.save(recordPath)) {
+        std::cerr << "Error: Could not write replay " << recordPath << "."
+                  << std::endl;
+      }
+      if (archive != nullptr) {
+        std::lock_guard<std::mutex> lock(archiveMutex);
+        if (!archive->append(recording)) {
+          std::cerr << "Error: Could not append game " << i
+                    << " to the archive." << std::endl;
+        }
+      }
+    });
+  }
+  std::chrono::duration<double> seconds =
+      std::chrono::steady_clock::now() - start;
+
+  long totalScore = 0;
+  long totalLines = 0;
+  long totalPieces = 0;
+  int maxScore = 0;
+  int maxLevel = 0;
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const GameResult &result = results[i];
+    if (perGame) {
+      std::cout << "game " << i << ": score " << result.score << ", lines "
+                << result.linesCleared << ", level " << result.level
+                << ", pieces " << result.piecesPlaced << std::endl;
+    }
+    totalScore += result.score;
+    totalLines += result.linesCleared;
+    totalPieces += result.piecesPlaced;
+    maxScore = std::max(maxScore, result.score);
+    maxLevel = std::max(maxLevel, result.level);
+  }
+
+  int games = std::max(numGames, 1);
+  std::cout << "seed " << seed << ", " << numGames
+            << " games: mean score " << totalScore / games << ", max score "
+            << maxScore << ", mean lines " << totalLines / games
+            << ", max level " << maxLevel << ", pieces " << totalPieces
+            << std::endl;
+  std::cout << seconds.count() << "s, " << numGames / seconds.count()
+            << " games/s, " << totalPieces / seconds.count() << " pieces/s"
+            << std::endl;
+  return 0;
+}
@@ -3,7 +3,10 @@
 // Author: Hannah Bast <bast@cs.uni-freiburg.de>
 
 #include "./TerminalManager.h"
+#include "./FrameStats.h"
 #include <ncurses.h>
+#include <poll.h>
+#include <unistd.h>
 
 static constexpr size_t systemColors = 16;
 
@@ -18,6 +21,7 @@ bool UserInput::isKeyRight() const { return keycode_ == KEY_RIGHT; }
 bool UserInput::isKeyUp() const { return keycode_ == KEY_UP; }
 bool UserInput::isKeyDown() const { return keycode_ == KEY_DOWN; }
 bool UserInput::isMouseclick() const { return mouseRow_ != -1; }
+bool UserInput::isEmpty() const { return keycode_ == ERR; }
 
 // ____________________________________________________________________________
 TerminalManager::TerminalManager(
@@ -63,23 +67,46 @@ TerminalManager::TerminalManager(
   // Set the logical dimensions of the screen.
   numRows_ = LINES;
   numCols_ = COLS / 2;
+
+  // Nothing has been drawn yet
+  back_ = FrameBuffer(numRows_, numCols_);
+  front_ = FrameBuffer(numRows_, numCols_);
+  back_.clear(FrameBuffer::Cell{'\0'});
+  front_.clear(FrameBuffer::Cell{'\0'});
 }
 
 // ____________________________________________________________________________
 TerminalManager::~TerminalManager() { endwin(); }
 
 // ____________________________________________________________________________
-void TerminalManager::refresh() { ::refresh(); }
+void TerminalManager::refresh() {
+  ScopedTimer timer(FrameSection::Refresh);
+
+  // Write only the cells that differ from what is on the terminal, one write
+  // per run of cells with the same color
+  numRunsWritten_ = back_.diff(front_, [](int row, int charCol,
+                                          const FrameBuffer::Cell &c,
+                                          const char *text, int length) {
+    attrset(COLOR_PAIR(c.color + systemColors) | (c.pixel ? A_REVERSE : 0));
+    mvaddnstr(row, charCol, text, length);
+  });
+  ::refresh();
+}
 
 // ____________________________________________________________________________
 void TerminalManager::drawPixel(int col, int row, int color) {
   if (color >= numColors_) {
     throw std::runtime_error("Invalid color given to drawPixel");
   }
-  attron(COLOR_PAIR(color + systemColors));
-  attron(A_REVERSE);
-  mvprintw(row, 2 * col, "  ");
-  attroff(A_REVERSE);
+  back_.drawPixel(col, row, color);
+}
+
+// ____________________________________________________________________________
+void TerminalManager::drawPixelRun(int col, int row, int length, int color) {
+  if (color >= numColors_) {
+    throw std::runtime_error("Invalid color given to drawPixelRun");
+  }
+  back_.drawPixelRun(col, row, length, color);
 }
 
 // ____________________________________________________________________________
@@ -96,11 +123,23 @@ UserInput TerminalManager::getUserInput() {
   return userInput;
 }
 
+// ____________________________________________________________________________
+bool TerminalManager::waitForInput(std::chrono::nanoseconds timeout) {
+  pollfd stdinFd{STDIN_FILENO, POLLIN, 0};
+  timespec timeoutSpec;
+  timespec *timeoutPtr = nullptr;
+  if (timeout.count() >= 0) {
+    timeoutSpec.tv_sec = timeout.count() / 1000000000;
+    timeoutSpec.tv_nsec = timeout.count() % 1000000000;
+    timeoutPtr = &timeoutSpec;
+  }
+  return ppoll(&stdinFd, 1, timeoutPtr, nullptr) > 0;
+}
+
 // ____________________________________________________________________________
 void TerminalManager::drawString(int row, int col, int color, const char *str) {
   if (color >= numColors_) {
     throw std::runtime_error("Invalid color given to drawString");
   }
-  attron(COLOR_PAIR(color + systemColors));
-  mvprintw(row, 2 * col, "%s", str);
+  back_.drawString(row, col, color, str);
 }
\ No newline at end of file
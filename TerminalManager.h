@@ -5,6 +5,9 @@
 
 #pragma once
 
+#include "FrameBuffer.h"
+#include "RenderSink.h"
+#include <chrono>
 #include <stdexcept>
 #include <utility>
 #include <vector>
@@ -43,6 +46,8 @@ public:
   bool isKeyUp() const;
   bool isKeyDown() const;
   bool isMouseclick() const;
+  // True if no key was pressed.
+  bool isEmpty() const;
   // The code of the key that was pressed.
   int keycode_;
   int mouseRow_ = -1;
@@ -50,7 +55,7 @@ public:
 };
 
 // A class to draw pixels on or read input from the terminal, using ncurses.
-class TerminalManager {
+class TerminalManager : public RenderSink {
 public:
   // Constructor: Set up the terminal for use with ncurses commands.
   // The argument specifies the colors that we want to use with this terminal
@@ -60,29 +65,50 @@ public:
   TerminalManager(const std::vector<std::pair<Color, Color>> &colors);
 
   // Destructor: Clean up the terminal after use.
-  ~TerminalManager();
+  ~TerminalManager() override;
 
   // Draw a pixel at the given logical position in the given color.
   // Note: the pixel is drawn with the foreground color of the
   // color pair with the given index that was specified in the constructor.
-  void drawPixel(int row, int col, int color);
+  // Nothing is written to the terminal until `refresh` is called.
+  void drawPixel(int col, int row, int color) override;
+
+  // Draw a run of pixels in the same color.
+  void drawPixelRun(int col, int row, int length, int color) override;
 
   // Draw a string at the given logical position and color.
-  void drawString(int row, int col, int color, const char *str);
+  void drawString(int row, int col, int color, const char *str) override;
+
+  // Show the contents of the screen. This submits the whole frame at once:
+  // only the cells which changed since the last call are written to the
+  // terminal, neighbouring cells of the same color with a single write.
+  void refresh() override;
 
-  // Show the contents of the screen.
-  void refresh();
+  // Return how many runs of cells were written to the terminal by the last
+  // refresh.
+  int numRunsWritten() const { return numRunsWritten_; }
 
   // Return the logical dimensions of the screen.
   int numRows() { return numRows_; }
   int numCols() { return numCols_; }
 
-  // Get user input.
+  // Get user input. Does not block, if no key is pending the returned input
+  // is empty.
   UserInput getUserInput();
 
+  // Block until input is pending or the timeout expired. A negative timeout
+  // waits without a time limit. Return true if input is pending.
+  bool waitForInput(std::chrono::nanoseconds timeout);
+
 private:
   // The logical dimensions of the screen.
   int numRows_;
   int numCols_;
   int numColors_;
+
+  // The frame which is being drawn and the frame which is currently shown on
+  // the terminal. Cells which were never written hold '\0'.
+  FrameBuffer back_;
+  FrameBuffer front_;
+  int numRunsWritten_ = 0;
 };
\ No newline at end of file
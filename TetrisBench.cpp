@@ -0,0 +1,157 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "./AutoPlayer.h"
+#include "./FrameBuffer.h"
+#include "./Game.h"
+#include "./RenderSink.h"
+#include "./Tetromino.h"
+#include <benchmark/benchmark.h>
+
+// Access to the private helpers of Game
+struct GameBenchAccess {
+  static Board &board(Game &game) { return game.board_; }
+  static bool checkCollision(Game &game, int dx, int dy, int rotation) {
+    return game.checkCollision(dx, dy, rotation);
+  }
+  static void placeTetromino(Game &game) { game.placeTetromino(); }
+  static void clearFullLines(Game &game) { game.clearFullLines(); }
+  // Reset the counters placeTetromino and clearFullLines increase
+  static void resetCounters(Game &game) {
+    game.piecesPlaced_ = 0;
+    game.tetrisCount_ = 0;
+    game.linesCleared_ = 0;
+    game.score_ = 0;
+  }
+  static void setGhostPiece(Game &game, RenderSink &renderSink) {
+    game.setGhostPiece(renderSink);
+  }
+};
+
+// Let the computer play a few tetrominos, so the board has a realistic stack
+static void playPieces(Game &game, int count) {
+  AutoPlayer autoPlayer(1);
+  for (int i = 0; i < count && autoPlayer.playMove(game, 1); ++i) {
+    game.tick();
+  }
+}
+
+// ____________________________________________________________________________
+
+static void BM_TetrominoReset(benchmark::State &state) {
+  Tetromino tetromino;
+  int type = 0;
+  for (auto _ : state) {
+    tetromino.reset(static_cast<TetrominoType>(type));
+    benchmark::DoNotOptimize(tetromino);
+    type = type == 6 ? 0 : type + 1;
+  }
+}
+BENCHMARK(BM_TetrominoReset);
+
+// ____________________________________________________________________________
+
+static void BM_TetrominoGetShape(benchmark::State &state) {
+  Tetromino tetromino(TetrominoType::T);
+  int rotation = 0;
+  for (auto _ : state) {
+    ShapeView shape = tetromino.getShape(rotation);
+    benchmark::DoNotOptimize(shape);
+    rotation = (rotation + 1) & 3;
+  }
+}
+BENCHMARK(BM_TetrominoGetShape);
+
+// ____________________________________________________________________________
+
+static void BM_CheckCollision(benchmark::State &state) {
+  NullRenderSink renderSink;
+  Game game(renderSink, 1);
+  playPieces(game, 20);
+  int dx = -1;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        GameBenchAccess::checkCollision(game, dx, 1, dx + 1));
+    dx = dx == 1 ? -1 : dx + 1;
+  }
+}
+BENCHMARK(BM_CheckCollision);
+
+// ____________________________________________________________________________
+
+// Place the current tetromino on the floor. The board is copied back and the
+// counters are reset after every placement, which is part of the measured
+// time.
+static void BM_PlaceTetromino(benchmark::State &state) {
+  NullRenderSink renderSink;
+  Game game(renderSink, 1);
+  GameBenchAccess::board(game).clear();
+  while (!GameBenchAccess::checkCollision(game, 0, 0, 0) &&
+         !GameBenchAccess::checkCollision(game, 0, 1, 0)) {
+    game.applyAction(ReplayAction::MoveDown);
+  }
+  Board empty = GameBenchAccess::board(game);
+  for (auto _ : state) {
+    GameBenchAccess::placeTetromino(game);
+    benchmark::ClobberMemory();
+    GameBenchAccess::board(game) = empty;
+    GameBenchAccess::resetCounters(game);
+  }
+}
+BENCHMARK(BM_PlaceTetromino);
+
+// ____________________________________________________________________________
+
+// Clear state.range(0) full rows at the bottom of a stack. The board is copied
+// back and the counters are reset after every clear, which is part of the
+// measured time.
+static void BM_ClearFullLines(benchmark::State &state) {
+  NullRenderSink renderSink;
+  Game game(renderSink, 1);
+  Board &board = GameBenchAccess::board(game);
+  board.clear();
+  int fullRows = static_cast<int>(state.range(0));
+  for (int y = 0; y < 8; ++y) {
+    for (int x = 0; x < Board::width_; ++x) {
+      // Full rows at the bottom, rows with a gap above them
+      if (y < fullRows || x != y % Board::width_) {
+        board.set(x, Board::height_ - 1 - y, 1 + x % 7);
+      }
+    }
+  }
+  Board stack = board;
+  for (auto _ : state) {
+    GameBenchAccess::clearFullLines(game);
+    benchmark::ClobberMemory();
+    board = stack;
+    GameBenchAccess::resetCounters(game);
+  }
+}
+BENCHMARK(BM_ClearFullLines)->DenseRange(0, 4);
+
+// ____________________________________________________________________________
+
+static void BM_SetGhostPiece(benchmark::State &state) {
+  FrameBuffer frameBuffer;
+  Game game(frameBuffer, 1);
+  playPieces(game, 20);
+  for (auto _ : state) {
+    GameBenchAccess::setGhostPiece(game, frameBuffer);
+  }
+}
+BENCHMARK(BM_SetGhostPiece);
+
+// ____________________________________________________________________________
+
+// A whole frame into a frame buffer, without a terminal
+static void BM_Update(benchmark::State &state) {
+  FrameBuffer frameBuffer;
+  Game game(frameBuffer, 1);
+  playPieces(game, 20);
+  for (auto _ : state) {
+    game.update(frameBuffer);
+  }
+}
+BENCHMARK(BM_Update);
+
+BENCHMARK_MAIN();
@@ -1,19 +1,51 @@
 // Copyright Paul Tröster
 // Ü11 - Uni Freiburg
 
+#include "AutoPlayer.h"
 #include "Colors.h"
+#include "FixedTimestep.h"
+#include "FrameStats.h"
 #include "Game.h"
+#include "Replay.h"
 #include "TerminalManager.h"
 #include "Tetromino.h"
+#include "ThreadPool.h"
+#include <algorithm>
 #include <chrono>
+#include <fstream>
 #include <iostream>
-#include <thread>
+#include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
 int main(int argc, char *argv[]) {
 
   int argValue = 0; // Default value
+  bool hasArgValue = false;
+
+  // Logic ticks per second, the level speeds are counted in ticks
+  int tickRate = 60;
+
+  // Let the computer play, looking at the given number of pieces
+  bool autoplay = false;
+  int lookahead = 2;
+
+  // Use the 7-bag randomizer instead of the classic one
+  RandomizerMode randomizerMode = RandomizerMode::Classic;
+
+  // Seed of the tetromino sequence, from the clock if not given
+  bool hasSeed = false;
+  unsigned long long seed = 0;
+
+  // Record the game into this file, or play the replay in this file back at
+  // the given speed
+  std::string recordPath;
+  std::string replayPath;
+  double speed = 1;
+
+  // Write the frame section times into this file at the end
+  std::string statsPath;
 
   char rotateLeft = 'j';
   char rotate180 = 'k';
@@ -30,7 +62,77 @@ int main(int argc, char *argv[]) {
     } else if (std::string(argv[i]) == "--rotate-right" && i + 1 < argc) {
       rotateRight = argv[i + 1][0];
       ++i;
+    } else if (std::string(argv[i]) == "--tick-rate" && i + 1 < argc) {
+      try {
+        tickRate = std::stoi(argv[i + 1]);
+      } catch (std::exception &e) {
+        tickRate = 0;
+      }
+      if (tickRate <= 0 || tickRate > FixedTimestep::maxTicksPerSecond_) {
+        std::cerr << "Error: Tick rate must be a positive integer of at most "
+                  << FixedTimestep::maxTicksPerSecond_ << "." << std::endl;
+        return 1;
+      }
+      ++i;
+    } else if (std::string(argv[i]) == "--seed" && i + 1 < argc) {
+      try {
+        seed = std::stoull(argv[i + 1]);
+      } catch (std::exception &e) {
+        std::cerr << "Error: Seed must be a non-negative integer."
+                  << std::endl;
+        return 1;
+      }
+      hasSeed = true;
+      ++i;
+    } else if (std::string(argv[i]) == "--autoplay") {
+      autoplay = true;
+    } else if (std::string(argv[i]) == "--lookahead" && i + 1 < argc) {
+      try {
+        lookahead = std::stoi(argv[i + 1]);
+      } catch (std::exception &e) {
+        lookahead = 0;
+      }
+      if (lookahead <= 0) {
+        std::cerr << "Error: Lookahead must be a positive integer."
+                  << std::endl;
+        return 1;
+      }
+      ++i;
+    } else if (std::string(argv[i]) == "--bag") {
+      randomizerMode = RandomizerMode::SevenBag;
+    } else if (std::string(argv[i]) == "--record" && i + 1 < argc) {
+      recordPath = argv[i + 1];
+      ++i;
+    } else if (std::string(argv[i]) == "--replay" && i + 1 < argc) {
+      replayPath = argv[i + 1];
+      ++i;
+    } else if (std::string(argv[i]) == "--stats-file" && i + 1 < argc) {
+      statsPath = argv[i + 1];
+      ++i;
+    } else if (std::string(argv[i]) == "--speed" && i + 1 < argc) {
+      try {
+        speed = std::stod(argv[i + 1]);
+      } catch (std::exception &e) {
+        speed = 0;
+      }
+      if (!(speed > 0)) {
+        std::cerr << "Error: Speed must be a positive number." << std::endl;
+        return 1;
+      }
+      ++i;
+    } else if (hasArgValue) {
+      // Only one level can be given
+      std::cerr << "Error: Too many arguments." << std::endl;
+      std::cerr << "Usage: " << argv[0]
+                << " [--rotate-left <char>] [--rotate-180 <char>] "
+                   "[--rotate-right <char>] [--tick-rate <hz>] "
+                   "[--seed <n>] [--bag] [--autoplay] [--lookahead <n>] "
+                   "[--record <file>] [--replay <file> [--speed <x>]] "
+                   "[--stats-file <file>] [int]"
+                << std::endl;
+      return 1;
     } else {
+      hasArgValue = true;
       try {
         argValue = std::stoi(argv[i]);
       } catch (std::invalid_argument &e) {
@@ -45,53 +147,145 @@ int main(int argc, char *argv[]) {
     }
   }
 
-  // Check if there are too many arguments
-  if (argc > 7) { // 1 for program name + 6 potential args for keys
-    std::cerr << "Error: Too many arguments." << std::endl;
-    std::cerr << "Usage: " << argv[0]
-              << " [--rotate-left <char>] [--rotate-180 <char>] "
-                 "[--rotate-right <char>] [int]"
-              << std::endl;
+  // A replay runs at tickRate * speed ticks per second
+  if (!replayPath.empty() &&
+      tickRate * speed > FixedTimestep::maxTicksPerSecond_) {
+    std::cerr << "Error: Tick rate times speed must be at most "
+              << FixedTimestep::maxTicksPerSecond_ << "." << std::endl;
     return 1;
   }
 
+  // A replay decides seed, randomizer and level itself
+  Replay replay;
+  if (!replayPath.empty()) {
+    if (!replay.load(replayPath)) {
+      std::cerr << "Error: Could not read replay " << replayPath << "."
+                << std::endl;
+      return 1;
+    }
+    seed = replay.getSeed();
+    hasSeed = true;
+    randomizerMode = replay.getMode();
+    argValue = replay.getStartLevel();
+  }
+  ReplayPlayer replayPlayer(replay);
+
+  // Time the parts of every frame, 't' shows the times in the game
+  setSectionTimersEnabled(true);
+
   // Initialize Terminal Manager with the init_list
-  TerminalManager terminalManager(init_list);
+  // Held in a pointer to end ncurses before printing after the game
+  auto terminalManager = std::make_unique<TerminalManager>(init_list);
 
   // Initialize Game
-  Game game(terminalManager);
+  if (!hasSeed) {
+    seed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+  }
+  Game game(*terminalManager, seed, randomizerMode);
 
   // Set level/keys according to command line input
   game.setLevel(argValue);
   game.setRotationKeys(rotateLeft, rotate180, rotateRight);
 
-  // Count the frames to know wether a tetromino should move down
-  int frameCount = 0;
+  Replay recording(seed, randomizerMode, argValue);
+  if (!recordPath.empty()) {
+    game.setRecorder(&recording);
+  }
 
-  while (!game.isStopped()) {
-    char input = terminalManager.getUserInput().keycode_;
+  // The autoplayer expands its search on all cores
+  std::unique_ptr<ThreadPool> threadPool;
+  if (autoplay) {
+    threadPool = std::make_unique<ThreadPool>();
+  }
+  AutoPlayer autoPlayer(16, threadPool.get());
 
-    game.handleInput(input);
+  // Ticks since the autoplayer placed the last tetromino, it plays one
+  // tetromino per move down interval of the level
+  int autoplayTicks = 0;
 
-    // update game state if not paused and q wasnt pressed
-    if (!game.isPaused()) {
+  // Run the logic at a fixed rate, independent of the time rendering takes. A
+  // replay runs the same ticks, just more or less of them per second. The
+  // speed was checked above, the clamp keeps 8 * speedFactor an int.
+  int speedFactor = static_cast<int>(std::clamp(speed, 1.0, 1e8));
+  FixedTimestep timestep(
+      replayPath.empty() ? tickRate : std::max(1, int(tickRate * speed)),
+      8 * speedFactor);
 
-      frameCount++;
+  while (!game.isStopped()) {
+    int ticks = timestep.beginFrame();
 
-      game.update(terminalManager);
+    // Apply every key which is pending, not just one per frame
+    for (UserInput input = terminalManager->getUserInput(); !input.isEmpty();
+         input = terminalManager->getUserInput()) {
+      // A replay can only be stopped
+      if (replayPath.empty() || input.keycode_ == 'q') {
+        game.handleInput(input.keycode_);
+      }
+    }
 
-      // Check if the frameCount is greater then the move down event integer
-      if (game.mdTetromino() < frameCount) {
-        game.moveDown();
-        frameCount = 0;
+    // Advance the logic by every tick which is due, catching up if the last
+    // frame took too long
+    for (int i = 0; i < ticks; ++i) {
+      if (!replayPath.empty()) {
+        // The replay applies its actions and ticks, stop at its end
+        if (!replayPlayer.step(game)) {
+          game.handleInput('q');
+          break;
+        }
+        continue;
       }
+
+      game.tick();
+
+      if (autoplay && !game.isPaused() &&
+          ++autoplayTicks > game.mdTetromino()) {
+        autoPlayer.playMove(game, lookahead);
+        autoplayTicks = 0;
+      }
+    }
+
+    // update the screen if not paused and q wasnt pressed
+    if (!game.isPaused() && !game.isStopped()) {
+      game.update(*terminalManager);
     }
 
-    // 16ms should equal about 60 frames per second
-    std::this_thread::sleep_for(std::chrono::milliseconds(16));
+    // Show how much of the tick the frame needed in the next frame
+    timestep.endFrame();
+    game.setFrameBudget(timestep.budgetUsed());
+
+    // Sleep until a key is pressed or the next tick is due. A paused game
+    // only wakes up for keys, unless a replay unpauses it.
+    if (game.isPaused() && replayPath.empty()) {
+      terminalManager->waitForInput(std::chrono::nanoseconds(-1));
+    } else if (!game.isStopped()) {
+      FixedTimestep::Clock::duration untilTick =
+          timestep.nextTick() - FixedTimestep::Clock::now();
+      terminalManager->waitForInput(
+          std::max(untilTick, FixedTimestep::Clock::duration::zero()));
+    }
+  }
+
+  terminalManager.reset();
+
+  if (!recordPath.empty()) {
+    recording.finish(game.getTickCount());
+    if (!recording.save(recordPath)) {
+      std::cerr << "Error: Could not write replay " << recordPath << "."
+                << std::endl;
+    }
+  }
+
+  if (!statsPath.empty()) {
+    std::ofstream statsFile(statsPath);
+    writeSectionStats(statsFile);
+    if (!statsFile) {
+      std::cerr << "Error: Could not write stats " << statsPath << "."
+                << std::endl;
+    }
   }
 
-  terminalManager.~TerminalManager();
+  // Print the seed, so the game can be played again
+  std::cout << "Seed: " << game.getSeed() << std::endl;
 
   return 0;
 }
@@ -1,10 +1,43 @@
 // Copyright Paul Tröster
 // Ü11 - Uni Freiburg
 
+#include "./AutoPlayer.h"
+#include "./BoardFeatures.h"
+#include "./FixedTimestep.h"
+#include "./FrameBuffer.h"
+#include "./FrameStats.h"
 #include "./Game.h"
+#include "./MoveGenerator.h"
+#include "./Perft.h"
+#include "./PieceQueue.h"
+#include "./Random.h"
+#include "./RenderSink.h"
+#include "./Replay.h"
+#include "./ReplayArchive.h"
 #include "./Tetromino.h"
-#include "Colors.h"
+#include "./ThreadPool.h"
+#include "./TranspositionTable.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
+#include <queue>
+#include <random>
+#include <thread>
+
+// Copy a shape view into nested vectors to compare it with expected shapes
+static std::vector<std::vector<int>> toVector(ShapeView shape) {
+  std::vector<std::vector<int>> result(shape.height(),
+                                       std::vector<int>(shape.width()));
+  for (int y = 0; y < shape.height(); ++y) {
+    for (int x = 0; x < shape.width(); ++x) {
+      result[y][x] = shape.at(x, y);
+    }
+  }
+  return result;
+}
 
 TEST(Tetromino, DefaultConstructor) {
   // Default Tetromino
@@ -12,7 +45,8 @@ TEST(Tetromino, DefaultConstructor) {
 
   // Check default init. things
   ASSERT_EQ(tetromino_.rotationState_, 0);
-  ASSERT_EQ(tetromino_.getShape(), std::vector<std::vector<int>>({{1}}));
+  ASSERT_EQ(toVector(tetromino_.getShape()),
+            std::vector<std::vector<int>>({{1, 1, 1, 1}}));
 }
 
 TEST(Tetromino, TetrominoTypes) {
@@ -22,13 +56,13 @@ TEST(Tetromino, TetrominoTypes) {
   Tetromino tetrominoI(TetrominoType::I);
   ASSERT_EQ(tetrominoI.getType(), TetrominoType::I);
   std::vector<std::vector<int>> expectedShapeI = {{1, 1, 1, 1}};
-  ASSERT_EQ(tetrominoI.getShape(), expectedShapeI);
+  ASSERT_EQ(toVector(tetrominoI.getShape()), expectedShapeI);
 
   // Tetromino Type O
   Tetromino tetrominoO(TetrominoType::O);
   ASSERT_EQ(tetrominoO.getType(), TetrominoType::O);
   std::vector<std::vector<int>> expectedShapeO = {{2, 2}, {2, 2}};
-  ASSERT_EQ(tetrominoO.getShape(), expectedShapeO);
+  ASSERT_EQ(toVector(tetrominoO.getShape()), expectedShapeO);
 }
 
 TEST(Tetromino, ResetFunction) {
@@ -39,38 +73,145 @@ TEST(Tetromino, ResetFunction) {
 
   // Check for correct and expected Shape after reset and init
   std::vector<std::vector<int>> expectedShapeT = {{0, 3, 0}, {3, 3, 3}};
-  ASSERT_EQ(tetromino.getShape(), expectedShapeT);
+  ASSERT_EQ(toVector(tetromino.getShape()), expectedShapeT);
 }
 
 TEST(Tetromino, RotateFunction) {
   // Check wether a T piece is rotate correctly 4 times
   Tetromino tetromino(TetrominoType::T);
   tetromino.rotate(1);
-  ASSERT_EQ(tetromino.getShape(),
+  ASSERT_EQ(toVector(tetromino.getShape()),
             std::vector<std::vector<int>>({{3, 0}, {3, 3}, {3, 0}}));
   tetromino.rotate(1);
-  ASSERT_EQ(tetromino.getShape(),
+  ASSERT_EQ(toVector(tetromino.getShape()),
             std::vector<std::vector<int>>({{3, 3, 3}, {0, 3, 0}}));
   tetromino.rotate(1);
-  ASSERT_EQ(tetromino.getShape(),
+  ASSERT_EQ(toVector(tetromino.getShape()),
             std::vector<std::vector<int>>({{0, 3}, {3, 3}, {0, 3}}));
   tetromino.rotate(1);
-  ASSERT_EQ(tetromino.getShape(),
+  ASSERT_EQ(toVector(tetromino.getShape()),
             std::vector<std::vector<int>>({{0, 3, 0}, {3, 3, 3}}));
 }
 
 TEST(Tetromino, GetShapeFunction) {
   // Test if the get shape works correct for different kind of rotation
   Tetromino tetromino(TetrominoType::S);
-  ASSERT_EQ(tetromino.getShape(0),
+  ASSERT_EQ(toVector(tetromino.getShape(0)),
             std::vector<std::vector<int>>({{0, 4, 4}, {4, 4, 0}}));
-  ASSERT_EQ(tetromino.getShape(1),
+  ASSERT_EQ(toVector(tetromino.getShape(1)),
             std::vector<std::vector<int>>({{4, 0}, {4, 4}, {0, 4}}));
 }
 
+TEST(Board, SetAndGet) {
+  Board board;
+
+  // A new board is empty
+  ASSERT_TRUE(board.isRowEmpty(19));
+
+  // Setting a pixel updates the color and the occupancy mask
+  board.set(3, 19, 5);
+  ASSERT_EQ(board.get(3, 19), 5);
+  ASSERT_EQ(board.rowMask(19), 1 << 3);
+  ASSERT_TRUE(board.overlaps(19, 1 << 3));
+  ASSERT_FALSE(board.overlaps(19, 1 << 4));
+
+  // Setting 0 removes the pixel again
+  board.set(3, 19, 0);
+  ASSERT_TRUE(board.isRowEmpty(19));
+}
+
+TEST(Board, RemoveRow) {
+  Board board;
+
+  // Fill the bottom row and put a pixel above it
+  for (int x = 0; x < Board::width_; ++x) {
+    board.set(x, 19, 1);
+  }
+  board.set(2, 18, 4);
+  ASSERT_TRUE(board.isRowFull(19));
+
+  // The pixel above moves down into the removed row
+  board.removeRow(19);
+  ASSERT_EQ(board.rowMask(19), 1 << 2);
+  ASSERT_EQ(board.get(2, 19), 4);
+  ASSERT_TRUE(board.isRowEmpty(18));
+}
+
+TEST(Board, ClearFullLines) {
+  Board board;
+
+  // Full rows 19, 18 and 16 with a pixel in row 17 and one on top
+  for (int y : {19, 18, 16}) {
+    for (int x = 0; x < Board::width_; ++x) {
+      board.set(x, y, 1);
+    }
+  }
+  board.set(4, 17, 2);
+  board.set(7, 15, 3);
+
+  // The rows in between move down over all the gaps
+  std::uint32_t clearedRows;
+  ASSERT_EQ(board.clearFullLines(clearedRows), 3);
+  ASSERT_EQ(clearedRows, 1u << 19 | 1u << 18 | 1u << 16);
+  ASSERT_EQ(board.rowMask(19), 1 << 4);
+  ASSERT_EQ(board.get(4, 19), 2);
+  ASSERT_EQ(board.rowMask(18), 1 << 7);
+  ASSERT_EQ(board.get(7, 18), 3);
+  for (int y = 0; y < 18; ++y) {
+    ASSERT_TRUE(board.isRowEmpty(y));
+  }
+
+  // The hash matches a board set up directly
+  Board copy;
+  copy.set(4, 19, 2);
+  copy.set(7, 18, 3);
+  ASSERT_EQ(copy.getHash(), board.getHash());
+
+  // Nothing full, nothing changes
+  ASSERT_EQ(board.clearFullLines(clearedRows), 0);
+  ASSERT_EQ(clearedRows, 0u);
+  ASSERT_EQ(board.rowMask(19), 1 << 4);
+}
+
+TEST(Tetromino, MaskShape) {
+  // The row masks match the shape, bit x is column x
+  Tetromino tetromino(TetrominoType::L);
+  const TetrominoShape &shape = tetromino.getMaskShape(1);
+  ASSERT_EQ(shape.width, 2);
+  ASSERT_EQ(shape.height, 3);
+  ASSERT_EQ(toVector(tetromino.getShape(1)),
+            std::vector<std::vector<int>>({{7, 0}, {7, 0}, {7, 7}}));
+  ASSERT_EQ(shape.rows[2], 0b11);
+
+  // The view refers to the table entry instead of copying it
+  ASSERT_EQ(&tetromino.getShape(1).masks(), &shape);
+
+  // Rotating left from the start wraps around to the last rotation
+  tetromino.rotate(-1);
+  ASSERT_EQ(tetromino.rotationState_, 3);
+  ASSERT_EQ(tetromino.getNumRotations(), 4);
+}
+
+TEST(Tetromino, BottomProfile) {
+  // The bottom profile of every shape in the table matches its rows
+  for (int type = 0; type < 7; ++type) {
+    Tetromino tetromino(static_cast<TetrominoType>(type));
+    for (int r = 0; r < tetromino.getNumRotations(); ++r) {
+      const TetrominoShape &shape = tetromino.getMaskShape(r);
+      for (int col = 0; col < shape.width; ++col) {
+        int bottom = shape.height - 1;
+        while (!(shape.rows[bottom] >> col & 1)) {
+          bottom--;
+        }
+        ASSERT_EQ(shape.bottom[col], bottom);
+      }
+    }
+  }
+}
+
 TEST(Game, DefaultConstructor) {
-  TerminalManager terminalManager(init_list);
-  Game game(terminalManager);
+  NullRenderSink renderSink;
+  Game game(renderSink);
 
   ASSERT_EQ(game.tetrisCount_, 0);
   ASSERT_EQ(game.mdTetromino_, 48);
@@ -81,8 +222,8 @@ TEST(Game, DefaultConstructor) {
 }
 
 TEST(Game, HandleInput) {
-  TerminalManager terminalManager(init_list);
-  Game game(terminalManager);
+  NullRenderSink renderSink;
+  Game game(renderSink);
 
   game.handleInput('p'); // Pause the game
   ASSERT_EQ(game.isPaused(), true);
@@ -101,8 +242,8 @@ TEST(Game, HandleInput) {
 }
 
 TEST(Game, IncreaseScore) {
-  TerminalManager terminalManager(init_list);
-  Game game(terminalManager);
+  NullRenderSink renderSink;
+  Game game(renderSink);
 
   // Verify initial score
   ASSERT_EQ(game.score_, 0);
@@ -116,8 +257,8 @@ TEST(Game, IncreaseScore) {
 }
 
 TEST(Game, SetLevel) {
-  TerminalManager terminalManager(init_list);
-  Game game(terminalManager);
+  NullRenderSink renderSink;
+  Game game(renderSink);
 
   // Set level and verify
   game.setLevel(5);
@@ -128,8 +269,8 @@ TEST(Game, SetLevel) {
 }
 
 TEST(Game, SetRotationKeys) {
-  TerminalManager terminalManager(init_list);
-  Game game(terminalManager);
+  NullRenderSink renderSink;
+  Game game(renderSink);
 
   // Set rotation keys and verify
   game.setRotationKeys('a', 's', 'd');
@@ -144,21 +285,25 @@ TEST(Game, SetRotationKeys) {
 }
 
 TEST(Game, ClearFullLines) {
-  TerminalManager terminalManager(init_list);
-  Game game(terminalManager);
+  NullRenderSink renderSink;
+  Game game(renderSink);
 
   // Setup the game board with full line
-  game.board_[0] = std::vector<int>(game.board_[0].size(), 1);
+  for (int x = 0; x < Board::width_; ++x) {
+    game.board_.set(x, 0, 1);
+  }
 
   // Call the function in order to clear full lines
   game.clearFullLines();
 
-  ASSERT_EQ(game.board_[0], std::vector<int>(game.board_[0].size(), 0));
+  ASSERT_EQ(game.board_.rowMask(0), 0);
+  ASSERT_EQ(game.board_.get(0, 0), 0);
+  ASSERT_EQ(game.getClearedRows(), 1u);
 }
 
 TEST(Game, CheckCollision) {
-  TerminalManager terminalManager(init_list);
-  Game game(terminalManager);
+  NullRenderSink renderSink;
+  Game game(renderSink);
 
   Tetromino tetromino(TetrominoType::I);
   game.currentTetromino_ = tetromino;
@@ -171,20 +316,20 @@ TEST(Game, CheckCollision) {
 }
 
 TEST(Game, PlaceTetromino) {
-  TerminalManager terminalManager(init_list);
-  Game game(terminalManager);
+  NullRenderSink renderSink;
+  Game game(renderSink);
 
   Tetromino tetromino(TetrominoType::I);
   game.currentTetromino_ = tetromino;
 
   // Place the tetromino and verify
   game.placeTetromino();
-  ASSERT_EQ(game.board_[0][0], 0);
+  ASSERT_EQ(game.board_.get(0, 0), 0);
 }
 
 TEST(Game, SpawnTetromino) {
-  TerminalManager terminalManager(init_list);
-  Game game(terminalManager);
+  NullRenderSink renderSink;
+  Game game(renderSink);
 
   // Spawn a new tetromino and verify
   game.spawnTetromino();
@@ -195,8 +340,8 @@ TEST(Game, SpawnTetromino) {
 }
 
 TEST(Game, IncreaseLevelCheckLevel) {
-  TerminalManager terminalManager(init_list);
-  Game game(terminalManager);
+  NullRenderSink renderSink;
+  Game game(renderSink);
 
   // After 10 terises and being at a low level should be a level up
   game.tetrisCount_ = 10;
@@ -206,8 +351,8 @@ TEST(Game, IncreaseLevelCheckLevel) {
 }
 
 TEST(Game, SetScore) {
-  TerminalManager terminalManager(init_list);
-  Game game(terminalManager);
+  NullRenderSink renderSink;
+  Game game(renderSink);
 
   // Set the score and verify for tetris
   game.setScore(4);
@@ -215,19 +360,19 @@ TEST(Game, SetScore) {
 }
 
 TEST(Game, CheckTopOut) {
-  TerminalManager terminalManager(init_list);
-  Game game(terminalManager);
+  NullRenderSink renderSink;
+  Game game(renderSink);
 
   // Check for top out condition
-  game.board_[0][0] = 1; // Simulate a block at the top row
+  game.board_.set(0, 0, 1); // Simulate a block at the top row
 
   // Verify top out
   ASSERT_EQ(game.checkTopOut(), true);
 }
 
 TEST(Game, MoveLeft) {
-  TerminalManager terminalManager(init_list);
-  Game game(terminalManager);
+  NullRenderSink renderSink;
+  Game game(renderSink);
 
   int initialX = game.tetrominoX_;
 
@@ -237,8 +382,8 @@ TEST(Game, MoveLeft) {
 }
 
 TEST(Game, MoveRight) {
-  TerminalManager terminalManager(init_list);
-  Game game(terminalManager);
+  NullRenderSink renderSink;
+  Game game(renderSink);
 
   int initialX = game.tetrominoX_;
 
@@ -248,8 +393,8 @@ TEST(Game, MoveRight) {
 }
 
 TEST(Game, HardDrop) {
-  TerminalManager terminalManager(init_list);
-  Game game(terminalManager);
+  NullRenderSink renderSink;
+  Game game(renderSink);
 
   int initialY = game.tetrominoY_;
 
@@ -259,9 +404,38 @@ TEST(Game, HardDrop) {
             initialY); // The Y position should be less (dropped)
 }
 
+TEST(Game, SetGhostPiece) {
+  NullRenderSink renderSink;
+  Game game(renderSink, 1);
+  const TetrominoShape &shape = game.currentTetromino_.getMaskShape();
+
+  // On the empty board the tetromino falls to the floor
+  int floorY = Board::height_ - shape.height;
+  ASSERT_EQ(game.dropY(), floorY);
+
+  // Pixels under the tetromino change the board, the cached landing row is
+  // not used anymore
+  GameState state;
+  game.saveState(state);
+  for (int col = 0; col < shape.width; ++col) {
+    game.board_.set(game.tetrominoX_ + col, Board::height_ - 1, 1);
+  }
+  ASSERT_EQ(game.dropY(), game.board_.landingY(shape, game.tetrominoX_));
+  ASSERT_LT(game.dropY(), floorY);
+
+  // Neither after restoring an older board
+  game.restoreState(state);
+  ASSERT_EQ(game.dropY(), floorY);
+
+  // Below an overhang the tetromino falls from where it is
+  game.board_.set(game.tetrominoX_, 5, 1);
+  game.tetrominoY_ = 6;
+  ASSERT_EQ(game.dropY(), floorY);
+}
+
 TEST(Game, Rotate) {
-  TerminalManager terminalManager(init_list);
-  Game game(terminalManager);
+  NullRenderSink renderSink;
+  Game game(renderSink);
 
   // Assume initial rotation state of the tetromino
   int initialRotationState = game.currentTetromino_.rotationState_;
@@ -269,7 +443,8 @@ TEST(Game, Rotate) {
   // Rotate the tetromino
   game.rotate(1);
   ASSERT_EQ(game.currentTetromino_.rotationState_,
-            (initialRotationState + 1) % game.currentTetromino_.shape_.size());
+            (initialRotationState + 1) %
+                game.currentTetromino_.getNumRotations());
 
   // Rotate the tetromino back
   game.rotate(-1);
@@ -277,8 +452,8 @@ TEST(Game, Rotate) {
 }
 
 TEST(Game, TogglePause) {
-  TerminalManager terminalManager(init_list);
-  Game game(terminalManager);
+  NullRenderSink renderSink;
+  Game game(renderSink);
 
   // Assume initial pause state
   bool initialPauseState = game.paused_;
@@ -289,4 +464,933 @@ TEST(Game, TogglePause) {
   // Toggle pause again
   game.togglePause();
   ASSERT_EQ(game.paused_, initialPauseState);
-}
\ No newline at end of file
+}
+TEST(FrameBuffer, DrawPixelAndString) {
+  FrameBuffer frameBuffer(5, 10);
+
+  // A pixel fills both characters of its logical column
+  frameBuffer.drawPixel(2, 1, 6);
+  ASSERT_EQ(frameBuffer.pixelAt(2, 1), 6);
+  ASSERT_TRUE(frameBuffer.cell(1, 5).pixel);
+  ASSERT_EQ(frameBuffer.pixelAt(3, 1), -1);
+
+  // Strings use one character per letter and overwrite pixels
+  frameBuffer.drawString(1, 2, 0, "AB");
+  ASSERT_EQ(frameBuffer.textAt(1, 2, 2), "AB");
+  ASSERT_EQ(frameBuffer.pixelAt(2, 1), -1);
+
+  // Drawing outside of the buffer is ignored
+  frameBuffer.drawPixel(100, 100, 1);
+  frameBuffer.refresh();
+  ASSERT_EQ(frameBuffer.numFrames(), 1);
+}
+
+TEST(Game, UpdateFrameBuffer) {
+  FrameBuffer frameBuffer;
+  Game game(frameBuffer);
+
+  game.update(frameBuffer);
+
+  // Border, info panel and the current piece end up in the buffer
+  ASSERT_EQ(frameBuffer.pixelAt(0, 0), game.borderColor_);
+  ASSERT_EQ(frameBuffer.pixelAt(11, 20), game.borderColor_);
+  ASSERT_EQ(frameBuffer.textAt(3, 15, 4), "NEXT");
+  ShapeView shape = game.currentTetromino_.getShape();
+  int x = 0;
+  while (shape.at(x, 0) == 0) {
+    x++;
+  }
+  ASSERT_EQ(frameBuffer.pixelAt(game.tetrominoX_ + x + 1, game.tetrominoY_),
+            game.currentTetromino_.getColor());
+  ASSERT_EQ(frameBuffer.numFrames(), 1);
+}
+
+TEST(Game, DrawStats) {
+  FrameBuffer frameBuffer;
+  Game game(frameBuffer);
+  setSectionTimersEnabled(true);
+
+  // The section times are hidden until 't' is pressed, the update itself is
+  // timed
+  game.update(frameBuffer);
+  ASSERT_EQ(frameBuffer.textAt(3, 26, 7), "       ");
+  game.handleInput('t');
+  game.update(frameBuffer);
+  ASSERT_EQ(frameBuffer.textAt(3, 26, 7), "TIME us");
+  ASSERT_EQ(frameBuffer.textAt(4, 26, 6), "update");
+  ASSERT_GE(sectionHistogram(FrameSection::Update).count(), 2u);
+
+  // Pressing it again clears the area
+  game.handleInput('t');
+  game.update(frameBuffer);
+  ASSERT_EQ(frameBuffer.textAt(4, 26, 6), "      ");
+
+  // A rotation key on 't' rotates instead of showing them
+  game.setRotationKeys('t', 'k', 'l');
+  game.handleInput('t');
+  game.update(frameBuffer);
+  ASSERT_EQ(frameBuffer.textAt(3, 26, 7), "       ");
+  setSectionTimersEnabled(false);
+}
+
+TEST(LatencyHistogram, Percentiles) {
+  LatencyHistogram histogram;
+  ASSERT_EQ(histogram.percentile(0.5), 0u);
+
+  // Every duration lies in its bucket, the buckets are 12.5% wide
+  for (std::uint64_t ns : {0ull, 7ull, 8ull, 100ull, 12345ull, 1ull << 31}) {
+    int bucket = LatencyHistogram::bucketOf(ns);
+    ASSERT_LE(LatencyHistogram::bucketStart(bucket), ns);
+    ASSERT_GT(LatencyHistogram::bucketStart(bucket + 1), ns);
+  }
+  ASSERT_EQ(LatencyHistogram::bucketOf(1ull << 40),
+            LatencyHistogram::numBuckets_ - 1);
+
+  // 1000 durations of 1-1000 us, recorded from several threads
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&histogram, t]() {
+      for (int i = t; i < 1000; i += 4) {
+        histogram.record((i + 1) * 1000);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(histogram.count(), 1000u);
+  ASSERT_EQ(histogram.max(), 1000000u);
+  ASSERT_GE(histogram.percentile(0.5), 500000u);
+  ASSERT_LE(histogram.percentile(0.5), 500000u * 9 / 8);
+  ASSERT_GE(histogram.percentile(0.99), 990000u);
+  ASSERT_LE(histogram.percentile(0.99), 1000000u);
+
+  histogram.reset();
+  ASSERT_EQ(histogram.count(), 0u);
+}
+
+TEST(FrameBuffer, Diff) {
+  FrameBuffer front(5, 10);
+  FrameBuffer back(5, 10);
+
+  // A run of pixels plus a string in another color gives two runs
+  back.drawPixelRun(1, 1, 3, 3);
+  back.drawString(1, 4, 0, "AB");
+  std::vector<std::string> runs;
+  ASSERT_EQ(back.diff(front,
+                      [&runs](int row, int charCol, const FrameBuffer::Cell &c,
+                              const char *text, int length) {
+                        ASSERT_EQ(row, 1);
+                        runs.push_back(std::to_string(charCol) + ":" +
+                                       std::to_string(c.color) + ":" +
+                                       std::string(text, length));
+                      }),
+            2);
+  ASSERT_EQ(runs, std::vector<std::string>({"2:3:      ", "8:0:AB"}));
+
+  // Drawing the same pixels again changes nothing
+  back.drawPixel(1, 1, 3);
+  ASSERT_EQ(back.diff(front, [](int, int, const FrameBuffer::Cell &,
+                                const char *, int) {}),
+            0);
+}
+
+TEST(Game, Tick) {
+  NullRenderSink renderSink;
+  Game game(renderSink);
+
+  int startY = game.tetrominoY_;
+
+  // Level 0 moves the tetromino down after 49 ticks
+  for (int i = 0; i < 48; ++i) {
+    game.tick();
+  }
+  ASSERT_EQ(game.tetrominoY_, startY);
+  game.tick();
+  ASSERT_EQ(game.tetrominoY_, startY + 1);
+
+  // A paused game does not move
+  game.togglePause();
+  for (int i = 0; i < 100; ++i) {
+    game.tick();
+  }
+  ASSERT_EQ(game.tetrominoY_, startY + 1);
+}
+
+TEST(FixedTimestep, CatchUp) {
+  FixedTimestep timestep(100, 5);
+  FixedTimestep::Clock::time_point start = timestep.nextTick();
+  std::chrono::milliseconds tick(10);
+
+  // The first tick is due right away, the next one 10ms later
+  ASSERT_EQ(timestep.beginFrame(start), 1);
+  ASSERT_EQ(timestep.beginFrame(start + tick / 2), 0);
+
+  // A frame that took 3 ticks is caught up with 3 ticks at once
+  ASSERT_EQ(timestep.beginFrame(start + 3 * tick), 3);
+  ASSERT_EQ(timestep.nextTick(), start + 4 * tick);
+
+  // Half a tick of work uses half of the budget
+  timestep.endFrame(start + 3 * tick + tick / 2);
+  ASSERT_EQ(timestep.budgetUsed(), 50);
+
+  // Falling behind too far drops the ticks above the catch up limit
+  ASSERT_EQ(timestep.beginFrame(start + 20 * tick), 5);
+  ASSERT_EQ(timestep.droppedTicks(), 12);
+  ASSERT_EQ(timestep.nextTick(), start + 21 * tick);
+}
+
+TEST(FixedTimestep, ClampedRate) {
+  // Rates beyond one tick per nanosecond still give ticks of 1ns
+  FixedTimestep fast(2000000000, 5);
+  ASSERT_EQ(fast.tickDuration(), std::chrono::nanoseconds(1));
+  FixedTimestep::Clock::time_point start = fast.nextTick();
+  ASSERT_EQ(fast.beginFrame(start + std::chrono::nanoseconds(2)), 3);
+  ASSERT_EQ(fast.beginFrame(start + std::chrono::microseconds(1)), 5);
+  fast.endFrame(start + std::chrono::microseconds(2));
+  ASSERT_EQ(fast.budgetUsed(), 100000);
+
+  // A rate of 0 becomes one tick per second
+  FixedTimestep slow(0);
+  ASSERT_EQ(slow.tickDuration(), std::chrono::seconds(1));
+}
+
+// Reference for generatePlacements: a plain breadth first search over all
+// positions, using the collision check of the game
+static std::vector<Placement> searchPlacements(const Board &board,
+                                               TetrominoType type) {
+  Tetromino tetromino(type);
+  int n = tetromino.getNumRotations();
+  std::vector<Placement> result;
+  std::vector<bool> visited(4 * Board::height_ * Board::width_, false);
+  auto index = [](const Placement &p) {
+    return (p.rotation * Board::height_ + p.y) * Board::width_ + p.x;
+  };
+  auto fits = [&](const Placement &p) {
+    return !board.collides(tetromino.getMaskShape(p.rotation), p.x, p.y);
+  };
+
+  std::queue<Placement> queue;
+  Placement spawn{0, Tetromino::spawnX_, Tetromino::spawnY_};
+  if (fits(spawn)) {
+    queue.push(spawn);
+    visited[index(spawn)] = true;
+  }
+  while (!queue.empty()) {
+    Placement p = queue.front();
+    queue.pop();
+    Placement down{p.rotation, p.x, p.y + 1};
+    if (!fits(down)) {
+      result.push_back(p);
+    }
+    std::vector<Placement> next = {
+        {p.rotation, p.x - 1, p.y}, {p.rotation, p.x + 1, p.y}, down,
+        {(p.rotation + 1) % n, p.x, p.y}, {(p.rotation + n - 1) % n, p.x, p.y},
+        {(p.rotation + 2) % n, p.x, p.y}};
+    for (const Placement &q : next) {
+      if (fits(q) && !visited[index(q)]) {
+        visited[index(q)] = true;
+        queue.push(q);
+      }
+    }
+  }
+  return result;
+}
+
+TEST(MoveGenerator, EmptyBoard) {
+  Board board;
+
+  // Every column at the bottom, for each distinct rotation
+  ASSERT_EQ(generatePlacements(board, TetrominoType::O).size(), 9u);
+  ASSERT_EQ(generatePlacements(board, TetrominoType::I).size(), 17u);
+  ASSERT_EQ(generatePlacements(board, TetrominoType::T).size(), 34u);
+
+  // Blocked spawn position
+  board.set(Tetromino::spawnX_, Tetromino::spawnY_, 1);
+  ASSERT_TRUE(generatePlacements(board, TetrominoType::O).empty());
+}
+
+TEST(MoveGenerator, MatchesSearch) {
+  std::mt19937 random(42);
+  auto order = [](const Placement &a, const Placement &b) {
+    return std::tie(a.rotation, a.y, a.x) < std::tie(b.rotation, b.y, b.x);
+  };
+
+  for (int i = 0; i < 200; ++i) {
+    // Random board with overhangs in the lower half
+    Board board;
+    for (int y = 8; y < Board::height_; ++y) {
+      for (int x = 0; x < Board::width_; ++x) {
+        if (random() % 100 < static_cast<unsigned>(3 * y)) {
+          board.set(x, y, 1);
+        }
+      }
+    }
+    for (int type = 0; type < 7; ++type) {
+      std::vector<Placement> expected =
+          searchPlacements(board, static_cast<TetrominoType>(type));
+      std::vector<Placement> actual =
+          generatePlacements(board, static_cast<TetrominoType>(type));
+      std::sort(expected.begin(), expected.end(), order);
+      std::sort(actual.begin(), actual.end(), order);
+      ASSERT_EQ(actual, expected);
+    }
+  }
+}
+
+TEST(Perft, KnownCounts) {
+  Board board;
+
+  // Two O pieces next to each other can be placed in either order, so there
+  // are fewer distinct boards than nodes
+  std::vector<PerftLevel> levels = perft(board, {TetrominoType::O}, 4);
+  ASSERT_EQ(levels.size(), 4u);
+  std::vector<long> nodes, distinct;
+  for (const PerftLevel &level : levels) {
+    nodes.push_back(level.nodes);
+    distinct.push_back(level.distinct);
+  }
+  ASSERT_EQ(nodes, std::vector<long>({9, 81, 489, 2458}));
+  ASSERT_EQ(distinct, std::vector<long>({9, 53, 260, 1156}));
+
+  // Mixed sequence
+  levels = perft(board, {TetrominoType::T, TetrominoType::I, TetrominoType::O},
+                 3);
+  ASSERT_EQ(levels[2].nodes, 5542);
+  ASSERT_EQ(levels[2].distinct, 5542);
+}
+
+TEST(ThreadPool, ParallelFor) {
+  ThreadPool threadPool(4);
+  ASSERT_EQ(threadPool.numThreads(), 4);
+
+  // Every index runs exactly once
+  std::vector<std::atomic<int>> counts(1000);
+  threadPool.parallelFor(1000, [&counts](int i) { counts[i]++; });
+  for (const std::atomic<int> &count : counts) {
+    ASSERT_EQ(count.load(), 1);
+  }
+}
+
+TEST(ThreadPool, WorkStealing) {
+  ThreadPool threadPool(4);
+  std::atomic<int> count(0);
+
+  // A task which spawns many slow tasks into its own queue, the other
+  // workers have to steal them
+  threadPool.submit([&threadPool, &count] {
+    for (int i = 0; i < 100; ++i) {
+      threadPool.submit([&count] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        count++;
+      });
+    }
+  });
+  threadPool.wait();
+  ASSERT_EQ(count.load(), 100);
+  ASSERT_GT(threadPool.numSteals(), 0);
+}
+
+TEST(AutoPlayer, EvaluateBoard) {
+  Board board;
+
+  // Column 0 has height 2 with a hole, column 1 height 1
+  board.set(0, 18, 1);
+  board.set(1, 19, 1);
+  HeuristicWeights weights{1, 0, 0, 0};
+  ASSERT_EQ(evaluateBoard(board, 0, weights), 3);
+  weights = HeuristicWeights{0, 0, 1, 0};
+  ASSERT_EQ(evaluateBoard(board, 0, weights), 1);
+  weights = HeuristicWeights{0, 0, 0, 1};
+  ASSERT_EQ(evaluateBoard(board, 0, weights), 2);
+  weights = HeuristicWeights{0, 1, 0, 0};
+  ASSERT_EQ(evaluateBoard(board, 4, weights), 4);
+}
+
+TEST(AutoPlayer, PlaysWithoutToppingOut) {
+  ThreadPool threadPool(2);
+  AutoPlayer autoPlayer(8, &threadPool);
+  Board board;
+  int linesCleared = 0;
+
+  // A fixed sequence of all types, looking one piece ahead
+  for (int i = 0; i < 300; ++i) {
+    TetrominoType current = static_cast<TetrominoType>(i * 3 % 7);
+    TetrominoType next = static_cast<TetrominoType>((i + 1) * 3 % 7);
+    Placement placement{};
+    ASSERT_TRUE(autoPlayer.choose(board, {current, next}, placement));
+
+    Tetromino tetromino(current);
+    ASSERT_FALSE(board.collides(tetromino.getMaskShape(placement.rotation),
+                                placement.x, placement.y));
+    board.place(tetromino.getMaskShape(placement.rotation), placement.x,
+                placement.y, tetromino.getColor());
+    linesCleared += board.clearFullLines();
+    ASSERT_TRUE(board.isRowEmpty(0));
+  }
+  ASSERT_GT(linesCleared, 100);
+}
+
+TEST(AutoPlayer, ThreadsDontChangeTheChoice) {
+  ThreadPool threadPool(4);
+  AutoPlayer threaded(16, &threadPool);
+  AutoPlayer single(16);
+  NullRenderSink renderSink;
+
+  // Play the same games with both, they must choose the same placements
+  for (std::uint64_t seed = 0; seed < 4; ++seed) {
+    Game game(renderSink, seed, RandomizerMode::SevenBag);
+    for (int i = 0; i < 100; ++i) {
+      std::vector<TetrominoType> pieces = {game.getCurrentType(),
+                                           game.getUpcomingType(0),
+                                           game.getUpcomingType(1)};
+      Placement expected{};
+      Placement placement{};
+      bool placed = single.choose(game.getBoard(), pieces, expected);
+      ASSERT_EQ(threaded.choose(game.getBoard(), pieces, placement), placed);
+      if (!placed) {
+        break;
+      }
+      ASSERT_EQ(placement, expected);
+      ASSERT_TRUE(game.placeAt(placement));
+    }
+  }
+}
+
+TEST(Game, PlaceAt) {
+  NullRenderSink renderSink;
+  Game game(renderSink);
+  game.currentTetromino_.reset(TetrominoType::I);
+
+  // The vertical I piece in the right most column
+  ASSERT_TRUE(game.placeAt(Placement{1, 9, 16}));
+  for (int y = 16; y < 20; ++y) {
+    ASSERT_EQ(game.board_.get(9, y), 1);
+  }
+  ASSERT_EQ(game.tetrominoY_, Tetromino::spawnY_);
+
+  // Out of bounds placements are rejected
+  ASSERT_FALSE(game.placeAt(Placement{0, 9, 0}));
+
+  // So are floating ones, the I piece would fall further
+  game.currentTetromino_.reset(TetrominoType::I);
+  ASSERT_FALSE(game.placeAt(Placement{1, 0, 10}));
+  for (int y = 0; y < 16; ++y) {
+    ASSERT_TRUE(game.board_.isRowEmpty(y));
+  }
+  ASSERT_TRUE(game.placeAt(Placement{1, 0, 16}));
+}
+
+TEST(Random, Uniform) {
+  Random random(7);
+  std::vector<int> counts(7, 0);
+  for (int i = 0; i < 7000; ++i) {
+    int value = random.uniform(7);
+    ASSERT_GE(value, 0);
+    ASSERT_LT(value, 7);
+    counts[value]++;
+  }
+  // Every value shows up about equally often
+  for (int count : counts) {
+    ASSERT_GT(count, 800);
+    ASSERT_LT(count, 1200);
+  }
+
+  // The same seed gives the same sequence
+  Random a(123);
+  Random b(123);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(a.next(), b.next());
+  }
+}
+
+TEST(Game, Seed) {
+  NullRenderSink renderSink;
+  Game a(renderSink, 42);
+  Game b(renderSink, 42);
+  ASSERT_EQ(a.getSeed(), 42u);
+
+  // Same seed, same tetrominos. Every type shows up, also as first piece.
+  std::vector<bool> seen(7, false);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(a.getCurrentType(), b.getCurrentType());
+    ASSERT_EQ(a.getNextType(), b.getNextType());
+    seen[static_cast<int>(a.getCurrentType())] = true;
+    a.spawnTetromino();
+    b.spawnTetromino();
+  }
+  ASSERT_EQ(std::count(seen.begin(), seen.end(), true), 7);
+}
+
+TEST(PieceQueue, SevenBag) {
+  PieceQueue queue(RandomizerMode::SevenBag, 5);
+  for (int bag = 0; bag < 20; ++bag) {
+    // The preview shows the types the following pops return
+    std::vector<TetrominoType> preview;
+    for (int i = 0; i < PieceQueue::maxPreview_; ++i) {
+      preview.push_back(queue.peek(i));
+    }
+    // Every bag contains every type exactly once
+    std::vector<bool> seen(7, false);
+    for (int i = 0; i < 7; ++i) {
+      TetrominoType type = queue.pop();
+      ASSERT_EQ(type, preview[i]);
+      ASSERT_FALSE(seen[static_cast<int>(type)]);
+      seen[static_cast<int>(type)] = true;
+    }
+  }
+
+  // Same seed and mode, same types
+  PieceQueue a(RandomizerMode::Classic, 9);
+  PieceQueue b(RandomizerMode::Classic, 9);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(a.peek(3), b.peek(3));
+    ASSERT_EQ(a.pop(), b.pop());
+  }
+}
+
+TEST(Game, SevenBag) {
+  NullRenderSink renderSink;
+  Game game(renderSink, 3, RandomizerMode::SevenBag);
+
+  // The upcoming types are the ones which spawn next
+  std::vector<TetrominoType> upcoming;
+  for (int i = 0; i < 4; ++i) {
+    upcoming.push_back(game.getUpcomingType(i));
+  }
+  ASSERT_EQ(upcoming[0], game.getNextType());
+  for (int i = 0; i < 4; ++i) {
+    game.spawnTetromino();
+    ASSERT_EQ(game.getCurrentType(), upcoming[i]);
+  }
+
+  // The first 14 tetrominos are two complete bags
+  Game other(renderSink, 3, RandomizerMode::SevenBag);
+  for (int bag = 0; bag < 2; ++bag) {
+    std::vector<bool> seen(7, false);
+    for (int i = 0; i < 7; ++i) {
+      seen[static_cast<int>(other.getCurrentType())] = true;
+      other.spawnTetromino();
+    }
+    ASSERT_EQ(std::count(seen.begin(), seen.end(), true), 7);
+  }
+}
+
+TEST(Game, Replay) {
+  NullRenderSink renderSink;
+  Game game(renderSink, 11, RandomizerMode::SevenBag);
+  game.setLevel(5);
+  game.setRotationKeys('j', 'k', 'l');
+  Replay recording(11, RandomizerMode::SevenBag, 5);
+  game.setRecorder(&recording);
+
+  // Keys, gravity, a pause and placements of the autoplayer
+  const std::string keys = "adljwskpxpdds";
+  AutoPlayer autoPlayer(2);
+  for (int i = 0; i < 600 && !game.isStopped(); ++i) {
+    if (i % 7 == 0) {
+      game.handleInput(keys[(i / 7) % keys.size()]);
+    }
+    if (i % 40 == 39) {
+      autoPlayer.playMove(game);
+    }
+    game.tick();
+  }
+  recording.finish(game.getTickCount());
+  ASSERT_GT(game.getPiecesPlaced(), 20);
+
+  // A few bytes per tetromino, even with a key every 7 ticks
+  ASSERT_LT(recording.bytes().size(), 6u * game.getPiecesPlaced());
+
+  // The log survives a round trip through its bytes
+  Replay replay;
+  ASSERT_TRUE(
+      replay.fromBytes(recording.bytes().data(), recording.bytes().size()));
+  ASSERT_EQ(replay.getSeed(), 11u);
+  ASSERT_EQ(replay.getMode(), RandomizerMode::SevenBag);
+  ASSERT_EQ(replay.getStartLevel(), 5);
+  ASSERT_FALSE(replay.fromBytes(recording.bytes().data(), 3));
+
+  // An unknown randomizer is rejected as well
+  std::vector<std::uint8_t> broken = recording.bytes();
+  broken[5] = 2;
+  ASSERT_FALSE(replay.fromBytes(broken.data(), broken.size()));
+  broken[5] = 0xFF;
+  ASSERT_FALSE(replay.fromBytes(broken.data(), broken.size()));
+
+  // Playing it back gives the same game
+  Game played(renderSink, replay.getSeed(), replay.getMode());
+  played.setLevel(replay.getStartLevel());
+  ReplayPlayer(replay).run(played);
+  ASSERT_EQ(played.getTickCount(), game.getTickCount());
+  ASSERT_EQ(played.getBoard().rowMasks(), game.getBoard().rowMasks());
+  ASSERT_EQ(played.getScore(), game.getScore());
+  ASSERT_EQ(played.getPiecesPlaced(), game.getPiecesPlaced());
+  ASSERT_EQ(played.getCurrentType(), game.getCurrentType());
+  ASSERT_EQ(played.tetrominoX_, game.tetrominoX_);
+  ASSERT_EQ(played.tetrominoY_, game.tetrominoY_);
+}
+
+TEST(ReplayArchive, AppendAndSeek) {
+  std::string path = testing::TempDir() + "TetrisTest.tra";
+  std::remove(path.c_str());
+  std::remove((path + ".idx").c_str());
+
+  // Record three games of the autoplayer
+  std::vector<Replay> replays;
+  NullRenderSink renderSink;
+  for (int i = 0; i < 3; ++i) {
+    Game game(renderSink, i, RandomizerMode::Classic);
+    Replay recording(i, RandomizerMode::Classic, 0);
+    game.setRecorder(&recording);
+    AutoPlayer autoPlayer(2);
+    for (int piece = 0; piece < 50 + 20 * i; ++piece) {
+      autoPlayer.playMove(game);
+      game.tick();
+    }
+    recording.finish(game.getTickCount());
+    replays.push_back(recording);
+  }
+
+  // Two writers, the second one appends to the archive of the first one
+  {
+    ReplayArchiveWriter writer(path, 16);
+    ASSERT_TRUE(writer.isOpen());
+    ASSERT_TRUE(writer.append(replays[0]));
+    ASSERT_TRUE(writer.append(replays[1]));
+  }
+  {
+    ReplayArchiveWriter writer(path, 16);
+    ASSERT_EQ(writer.size(), 2u);
+    ASSERT_TRUE(writer.append(replays[2]));
+  }
+
+  ReplayArchive archive;
+  ASSERT_TRUE(archive.open(path));
+  ASSERT_EQ(archive.size(), 3u);
+  for (std::size_t k = 0; k < 3; ++k) {
+    Replay replay;
+    ASSERT_TRUE(archive.replay(k, replay));
+    ASSERT_EQ(replay.bytes(), replays[k].bytes());
+  }
+
+  // Game 2 has 90 tetrominos, a keyframe at the start and every 16
+  ASSERT_EQ(archive.numKeyframes(2), 6u);
+  ASSERT_EQ(archive.keyframe(2, 0).state.piecesPlaced, 0);
+  ASSERT_EQ(archive.findKeyframe(2, 0), 0u);
+  ASSERT_EQ(archive.findKeyframe(2, 40), 2u);
+  ASSERT_EQ(archive.findKeyframe(2, 1000), 5u);
+
+  // A keyframe has the state of the game at its tick
+  ReplayKeyframe keyframe = archive.keyframe(2, 3);
+  ASSERT_EQ(keyframe.state.piecesPlaced, 48);
+  Game game(renderSink, 2, RandomizerMode::Classic);
+  ReplayPlayer player(replays[2]);
+  while (game.getTickCount() < keyframe.state.tickCount) {
+    player.step(game);
+  }
+  ASSERT_EQ(keyframe.state.board.rowMasks(), game.getBoard().rowMasks());
+  ASSERT_EQ(keyframe.state.score, game.getScore());
+  ASSERT_EQ(keyframe.eventOffset, player.eventOffset());
+
+  // The replay continues from the keyframe to the same end
+  player.run(game);
+  Game resumed(renderSink, 0);
+  resumed.restoreState(keyframe.state);
+  ReplayPlayer(replays[2], keyframe.eventOffset, keyframe.eventFrame)
+      .run(resumed);
+  ASSERT_EQ(resumed.getTickCount(), game.getTickCount());
+  ASSERT_EQ(resumed.getScore(), game.getScore());
+  ASSERT_EQ(resumed.getBoard().rowMasks(), game.getBoard().rowMasks());
+
+  std::remove(path.c_str());
+  std::remove((path + ".idx").c_str());
+}
+
+TEST(ReplayArchive, TruncatedArchive) {
+  std::string path = testing::TempDir() + "TetrisTestTruncated.tra";
+  std::remove(path.c_str());
+  std::remove((path + ".idx").c_str());
+
+  NullRenderSink renderSink;
+  Game game(renderSink, 4, RandomizerMode::Classic);
+  Replay recording(4, RandomizerMode::Classic, 0);
+  game.setRecorder(&recording);
+  AutoPlayer autoPlayer(2);
+  for (int piece = 0; piece < 40; ++piece) {
+    autoPlayer.playMove(game);
+    game.tick();
+  }
+  recording.finish(game.getTickCount());
+
+  // Cut the archive a few bytes into the record of the second game
+  std::uintmax_t firstEnd;
+  {
+    ReplayArchiveWriter writer(path, 16);
+    ASSERT_TRUE(writer.append(recording));
+    firstEnd = std::filesystem::file_size(path);
+    ASSERT_TRUE(writer.append(recording));
+  }
+  std::filesystem::resize_file(path, firstEnd + 4);
+
+  ReplayArchive archive;
+  ASSERT_TRUE(archive.open(path));
+  ASSERT_EQ(archive.size(), 2u);
+  Replay replay;
+  ASSERT_TRUE(archive.replay(0, replay));
+  ASSERT_EQ(archive.numKeyframes(0), 3u);
+
+  // The cut game and games behind the index read as empty
+  for (std::size_t k : {std::size_t{1}, std::size_t{2}, std::size_t{1000}}) {
+    ASSERT_FALSE(archive.replay(k, replay));
+    ASSERT_EQ(archive.numKeyframes(k), 0u);
+    ASSERT_EQ(archive.keyframe(k, 0).state.piecesPlaced, 0);
+    ASSERT_EQ(archive.findKeyframe(k, 10), 0u);
+  }
+  ASSERT_EQ(archive.keyframe(0, 3).eventOffset, 0u);
+  ASSERT_EQ(archive.keyframe(0, 3).state.tickCount, 0u);
+
+  std::remove(path.c_str());
+  std::remove((path + ".idx").c_str());
+}
+
+TEST(ReplayArchive, WriterChecksHeader) {
+  std::string path = testing::TempDir() + "TetrisTestForeign.tra";
+  std::remove((path + ".idx").c_str());
+
+  // Neither an unrelated file nor an archive of another version is appended
+  // to
+  for (const std::string &content :
+       {std::string("no archive"), std::string("TRAR\x05\0\0\0", 8)}) {
+    {
+      std::ofstream file(path, std::ios::binary);
+      file << content;
+    }
+    ReplayArchiveWriter writer(path);
+    ASSERT_FALSE(writer.isOpen());
+    ASSERT_FALSE(writer.append(Replay(1, RandomizerMode::Classic, 0)));
+    ASSERT_EQ(std::filesystem::file_size(path), content.size());
+    ASSERT_FALSE(std::filesystem::exists(path + ".idx"));
+  }
+
+  std::remove(path.c_str());
+  std::remove((path + ".idx").c_str());
+}
+
+TEST(Game, SaveRestoreState) {
+  NullRenderSink renderSink;
+  Game game(renderSink, 8, RandomizerMode::SevenBag);
+  AutoPlayer autoPlayer(2);
+  for (int i = 0; i < 30; ++i) {
+    autoPlayer.playMove(game);
+    game.tick();
+  }
+
+  // Take a snapshot, play on and go back to it
+  GameState state;
+  game.saveState(state);
+  std::vector<TetrominoType> types;
+  for (int i = 0; i < 20; ++i) {
+    types.push_back(game.getCurrentType());
+    autoPlayer.playMove(game);
+    game.tick();
+  }
+  int score = game.getScore();
+  game.restoreState(state);
+  ASSERT_EQ(game.getPiecesPlaced(), 30);
+  ASSERT_EQ(game.getTickCount(), 30u);
+
+  // A copy of the snapshot is a plain copy of its bytes
+  GameState copy;
+  std::memcpy(static_cast<void *>(&copy), &state, sizeof(GameState));
+  Game other(renderSink, 0);
+  other.restoreState(copy);
+  ASSERT_EQ(other.getSeed(), 8u);
+  ASSERT_EQ(other.getBoard().rowMasks(), game.getBoard().rowMasks());
+
+  // Both games play the same tetrominos as before
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_EQ(game.getCurrentType(), types[i]);
+    ASSERT_EQ(other.getCurrentType(), types[i]);
+    autoPlayer.playMove(game);
+    game.tick();
+    autoPlayer.playMove(other);
+    other.tick();
+  }
+  ASSERT_EQ(game.getScore(), score);
+  ASSERT_EQ(other.getScore(), score);
+}
+
+TEST(Board, Hash) {
+  // The hash after placing and clearing equals the hash of a board which
+  // was set up directly with the same occupancy
+  Board board;
+  ASSERT_EQ(board.getHash(), 0u);
+  std::mt19937 random(3);
+  for (int i = 0; i < 200; ++i) {
+    Tetromino tetromino(static_cast<TetrominoType>(random() % 7));
+    std::vector<Placement> placements =
+        generatePlacements(board, tetromino.getType());
+    if (placements.empty() || !board.isRowEmpty(0)) {
+      board.clear();
+      continue;
+    }
+    const Placement &p = placements[random() % placements.size()];
+    board.place(tetromino.getMaskShape(p.rotation), p.x, p.y,
+                tetromino.getColor());
+    board.clearFullLines();
+
+    Board copy;
+    for (int y = 0; y < Board::height_; ++y) {
+      for (int x = 0; x < Board::width_; ++x) {
+        copy.set(x, y, board.get(x, y));
+      }
+    }
+    ASSERT_EQ(copy.getHash(), board.getHash());
+  }
+
+  // Colors don't change the hash, the occupancy does
+  Board a;
+  Board b;
+  a.set(2, 5, 1);
+  b.set(2, 5, 4);
+  ASSERT_EQ(a.getHash(), b.getHash());
+  b.set(3, 5, 4);
+  ASSERT_NE(a.getHash(), b.getHash());
+  b.set(3, 5, 0);
+  ASSERT_EQ(a.getHash(), b.getHash());
+}
+
+TEST(Board, ColumnHeights) {
+  // The tracked heights and holes match a full scan after every placement,
+  // and dropY matches moving down row by row
+  Board board;
+  std::mt19937 random(5);
+  for (int i = 0; i < 300; ++i) {
+    Tetromino tetromino(static_cast<TetrominoType>(random() % 7));
+    std::vector<Placement> placements =
+        generatePlacements(board, tetromino.getType());
+    if (placements.empty() || !board.isRowEmpty(0)) {
+      board.clear();
+      continue;
+    }
+    const Placement &p = placements[random() % placements.size()];
+    const TetrominoShape &shape = tetromino.getMaskShape(p.rotation);
+    // From the top (above the surface) and from the placement, which may be
+    // under an overhang
+    for (int startY : {0, p.y}) {
+      if (board.collides(shape, p.x, startY)) {
+        continue;
+      }
+      int expectedY = startY;
+      while (!board.collides(shape, p.x, expectedY + 1)) {
+        expectedY++;
+      }
+      ASSERT_EQ(board.dropY(shape, p.x, startY), expectedY);
+    }
+
+    board.place(shape, p.x, p.y, tetromino.getColor());
+    board.clearFullLines();
+    BoardFeatures features;
+    computeFeatures(board, features, FeatureBackend::Scalar);
+    for (int x = 0; x < Board::width_; ++x) {
+      ASSERT_EQ(board.getColumnHeight(x), features.heights[x]);
+    }
+    ASSERT_EQ(board.getHoles(), features.holes);
+  }
+
+  // Removing the highest pixel of a column drops it to the next one
+  board.clear();
+  board.set(0, 19, 1);
+  board.set(0, 15, 1);
+  ASSERT_EQ(board.getColumnHeight(0), 5);
+  ASSERT_EQ(board.getHoles(), 3);
+  board.set(0, 15, 0);
+  ASSERT_EQ(board.getColumnHeight(0), 1);
+  ASSERT_EQ(board.getHoles(), 0);
+}
+
+TEST(TranspositionTable, ProbeAndStore) {
+  TranspositionTable table(4);
+  std::uint64_t value;
+  ASSERT_FALSE(table.probe(0, value));
+  ASSERT_FALSE(table.probe(1, value));
+  table.store(0, 0);
+  ASSERT_TRUE(table.probe(0, value));
+  ASSERT_EQ(value, 0u);
+
+  // Keys of the same slot replace each other
+  table.store(0x123, 7);
+  ASSERT_TRUE(table.probe(0x123, value));
+  ASSERT_EQ(value, 7u);
+  table.store(0x223, 9);
+  ASSERT_FALSE(table.probe(0x123, value));
+  table.clear();
+  ASSERT_FALSE(table.probe(0x223, value));
+
+  // Threads storing into the same slots never make a probe return the value
+  // of another key. Every value is its key times 3.
+  TranspositionTable shared(2);
+  ThreadPool threadPool(4);
+  std::atomic<int> mismatches{0};
+  threadPool.parallelFor(8, [&](int i) {
+    for (std::uint64_t n = 0; n < 20000; ++n) {
+      std::uint64_t key = (n * 8 + i) * 0x9E3779B97F4A7C15ULL;
+      shared.store(key, key * 3);
+      std::uint64_t other = ((n + 1) * 8 + 7 - i) * 0x9E3779B97F4A7C15ULL;
+      std::uint64_t found;
+      if (shared.probe(other, found) && found != other * 3) {
+        mismatches++;
+      }
+    }
+  });
+  ASSERT_EQ(mismatches, 0);
+}
+
+TEST(BoardFeatures, BackendsAgree) {
+  // A small board by hand: columns 0 and 2 have height 3, column 0 has a
+  // hole and column 1 is a well of depth 3 between them
+  Board board;
+  board.set(0, 17, 1);
+  board.set(0, 19, 1);
+  board.set(2, 17, 1);
+  board.set(2, 18, 1);
+  board.set(2, 19, 1);
+  BoardFeatures features;
+  computeFeatures(board, features, FeatureBackend::Scalar);
+  ASSERT_EQ(features.heights[0], 3);
+  ASSERT_EQ(features.heights[1], 0);
+  ASSERT_EQ(features.heights[2], 3);
+  ASSERT_EQ(features.aggregateHeight, 6);
+  ASSERT_EQ(features.holes, 1);
+  ASSERT_EQ(features.bumpiness, 9);
+  ASSERT_EQ(features.wells, 3);
+  // 17 empty rows with 2 each, row 17 and 19: |#.#.......| gives 4, row 18:
+  // |..#.......| gives 4
+  ASSERT_EQ(features.rowTransitions, 17 * 2 + 3 * 4);
+
+  // Random boards, some full rows and holes, all backends give the same
+  std::mt19937 random(9);
+  for (int i = 0; i < 2000; ++i) {
+    Board randomBoard;
+    int top = random() % (Board::height_ + 1);
+    for (int y = top; y < Board::height_; ++y) {
+      for (int x = 0; x < Board::width_; ++x) {
+        if (random() % 4 != 0) {
+          randomBoard.set(x, y, 1);
+        }
+      }
+    }
+    BoardFeatures expected;
+    computeFeatures(randomBoard, expected, FeatureBackend::Scalar);
+    for (FeatureBackend backend :
+         {FeatureBackend::SSE2, FeatureBackend::AVX2}) {
+      if (!isSupported(backend)) {
+        continue;
+      }
+      BoardFeatures actual;
+      computeFeatures(randomBoard, actual, backend);
+      ASSERT_EQ(actual, expected) << "board " << i;
+    }
+  }
+}
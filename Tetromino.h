@@ -3,15 +3,54 @@
 
 #pragma once
 
+#include <cstdint>
 #include <gtest/gtest.h>
-#include <vector>
+#include <type_traits>
 
 // Different types of tetrominos
 enum class TetrominoType { I, O, T, S, Z, J, L };
 
+// One rotation of a tetromino: the size of its bounding box, one mask per
+// row (bit x set means there is a pixel in column x) and the bottom profile
+// (the lowest row with a pixel per column)
+struct TetrominoShape {
+  int width;
+  int height;
+  std::uint8_t rows[4];
+  std::uint8_t bottom[4];
+};
+
+// A non-owning view of one rotation of a tetromino in the table. Cheap to
+// copy, nothing is allocated.
+class ShapeView {
+public:
+  ShapeView(const TetrominoShape &shape, int color)
+      : shape_(&shape), color_(color) {}
+
+  // Size of the bounding box
+  int width() const { return shape_->width; }
+  int height() const { return shape_->height; }
+
+  // Return the color at the given position, 0 if theres no pixel
+  int at(int x, int y) const {
+    return (shape_->rows[y] >> x) & 1 ? color_ : 0;
+  }
+
+  // Return the underlying row masks
+  const TetrominoShape &masks() const { return *shape_; }
+
+private:
+  const TetrominoShape *shape_;
+  int color_;
+};
+
 // A class for each tetromino to handle the state, shape and rotation
 class Tetromino {
 public:
+  // Position where new tetrominos appear on the board
+  static constexpr int spawnX_ = 4;
+  static constexpr int spawnY_ = 0;
+
   // Default constructor
   Tetromino();
 
@@ -21,14 +60,30 @@ public:
   // Reset the Tetromino with a new type
   void reset(TetrominoType type);
 
-  // Return the shape, according to the rotation
-  std::vector<std::vector<int>> getShape(int rotation = 0) const {
-    return shape_[(rotationState_ + rotation) % shape_.size()];
-  };
+  // Return a view of the shape, according to the rotation
+  ShapeView getShape(int rotation = 0) const {
+    return ShapeView(getMaskShape(rotation), getColor());
+  }
+
+  // Return the row masks of the shape, according to the rotation
+  const TetrominoShape &getMaskShape(int rotation = 0) const {
+    return shapes_[static_cast<int>(type_)][rotationIndex(rotation)];
+  }
 
   // Return the type.
   TetrominoType getType() const { return type_; }
 
+  // Return the current rotation index.
+  int getRotation() const { return rotationState_; }
+
+  // Return the color of the pixels, which is 1 + the index of the type
+  int getColor() const { return static_cast<int>(type_) + 1; }
+
+  // Return the number of distinct rotations
+  int getNumRotations() const {
+    return numRotations_[static_cast<int>(type_)];
+  }
+
   // Rotating logic.
   void rotate(int rotation);
 
@@ -36,14 +91,43 @@ private:
   // The shape stored as type
   TetrominoType type_;
 
-  // The shape of the tetromino in a vector
-  std::vector<std::vector<std::vector<int>>> shape_;
-
   // 0 : 0°, 1 : 90° right, 2 : 180°, 3 : 270°
   int rotationState_;
 
-  // Helper function for constructor.
-  void assignShape(TetrominoType type);
+  // Index into the rotation table for the current rotation + rotation
+  int rotationIndex(int rotation) const {
+    int n = getNumRotations();
+    return ((rotationState_ + rotation) % n + n) % n;
+  }
+
+  // Number of distinct rotations per type, symmetric rotations are left out
+  static constexpr int numRotations_[7] = {2, 1, 4, 2, 2, 4, 4};
+
+  // Shapes of all types and rotations, known at compile time
+  static constexpr TetrominoShape shapes_[7][4] = {
+      // I
+      {{4, 1, {0b1111}, {0, 0, 0, 0}}, {1, 4, {0b1, 0b1, 0b1, 0b1}, {3}}},
+      // O
+      {{2, 2, {0b11, 0b11}, {1, 1}}},
+      // T
+      {{3, 2, {0b010, 0b111}, {1, 1, 1}},
+       {2, 3, {0b01, 0b11, 0b01}, {2, 1}},
+       {3, 2, {0b111, 0b010}, {0, 1, 0}},
+       {2, 3, {0b10, 0b11, 0b10}, {1, 2}}},
+      // S
+      {{3, 2, {0b110, 0b011}, {1, 1, 0}}, {2, 3, {0b01, 0b11, 0b10}, {1, 2}}},
+      // Z
+      {{3, 2, {0b011, 0b110}, {0, 1, 1}}, {2, 3, {0b10, 0b11, 0b01}, {2, 1}}},
+      // J
+      {{3, 2, {0b001, 0b111}, {1, 1, 1}},
+       {2, 3, {0b11, 0b01, 0b01}, {2, 0}},
+       {3, 2, {0b111, 0b100}, {0, 0, 1}},
+       {2, 3, {0b10, 0b10, 0b11}, {2, 2}}},
+      // L
+      {{3, 2, {0b100, 0b111}, {1, 1, 1}},
+       {2, 3, {0b01, 0b01, 0b11}, {2, 2}},
+       {3, 2, {0b111, 0b001}, {1, 0, 0}},
+       {2, 3, {0b11, 0b10, 0b10}, {0, 2}}}};
 
   FRIEND_TEST(Tetromino, DefaultConstructor);
   FRIEND_TEST(Tetromino, TetrominoTypes);
@@ -51,5 +135,9 @@ private:
   FRIEND_TEST(Tetromino, RotateFunction);
   FRIEND_TEST(Tetromino, GetShapeFunction);
   FRIEND_TEST(Tetromino, ComprehensiveRotationTest);
+  FRIEND_TEST(Tetromino, MaskShape);
   FRIEND_TEST(Game, Rotate);
-};
\ No newline at end of file
+};
+
+// Tetrominos are copied around a lot, so keep them plain data
+static_assert(std::is_trivially_copyable_v<Tetromino>);
@@ -0,0 +1,149 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "ThreadPool.h"
+
+namespace {
+// The pool and queue index of the current thread, if it is a worker
+thread_local const ThreadPool *currentPool = nullptr;
+thread_local int currentIndex = -1;
+} // namespace
+
+// ____________________________________________________________________________
+
+ThreadPool::ThreadPool(int numThreads) {
+  // hardware_concurrency may return 0 if it is unknown
+  if (numThreads < 1) {
+    numThreads = 1;
+  }
+  for (int i = 0; i < numThreads; ++i) {
+    queues_.push_back(std::make_unique<WorkerQueue>());
+  }
+  for (int i = 0; i < numThreads; ++i) {
+    workers_.emplace_back([this, i] { work(i); });
+  }
+}
+
+// ____________________________________________________________________________
+
+ThreadPool::~ThreadPool() {
+  wait();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  taskAvailable_.notify_all();
+  for (std::thread &worker : workers_) {
+    worker.join();
+  }
+}
+
+// ____________________________________________________________________________
+
+void ThreadPool::submit(std::function<void()> task) {
+  int index;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_++;
+    // Workers keep their own tasks, others are spread round robin
+    if (currentPool == this) {
+      index = currentIndex;
+    } else {
+      index = nextQueue_;
+      nextQueue_ = (nextQueue_ + 1) % numThreads();
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+    queues_[index]->tasks.push_back(std::move(task));
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queued_++;
+  }
+  taskAvailable_.notify_one();
+}
+
+// ____________________________________________________________________________
+
+void ThreadPool::wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  allDone_.wait(lock, [this] { return pending_ == 0; });
+}
+
+// ____________________________________________________________________________
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)> &body) {
+  for (int i = 0; i < count; ++i) {
+    submit([&body, i] { body(i); });
+  }
+  wait();
+}
+
+// ____________________________________________________________________________
+
+long ThreadPool::numSteals() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return numSteals_;
+}
+
+// ____________________________________________________________________________
+
+bool ThreadPool::takeTask(int index, std::function<void()> &task) {
+  // Newest task of the own queue, it is most likely still in the cache
+  {
+    WorkerQueue &own = *queues_[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+
+  // Oldest task of the other queues, starting with the next one
+  for (int i = 1; i < numThreads(); ++i) {
+    WorkerQueue &other = *queues_[(index + i) % numThreads()];
+    std::lock_guard<std::mutex> lock(other.mutex);
+    if (!other.tasks.empty()) {
+      task = std::move(other.tasks.front());
+      other.tasks.pop_front();
+      std::lock_guard<std::mutex> countLock(mutex_);
+      numSteals_++;
+      return true;
+    }
+  }
+  return false;
+}
+
+// ____________________________________________________________________________
+
+void ThreadPool::work(int index) {
+  currentPool = this;
+  currentIndex = index;
+
+  while (true) {
+    std::function<void()> task;
+    if (!takeTask(index, task)) {
+      // Sleep until a task is queued somewhere
+      std::unique_lock<std::mutex> lock(mutex_);
+      taskAvailable_.wait(lock, [this] { return stop_ || queued_ > 0; });
+      if (stop_ && queued_ <= 0) {
+        return;
+      }
+      continue;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queued_--;
+    }
+
+    task();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--pending_ == 0) {
+      allDone_.notify_all();
+    }
+  }
+}
@@ -0,0 +1,78 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads which run submitted tasks. Every worker has
+// its own queue: tasks submitted from outside are spread over the queues,
+// tasks submitted by a worker go to its own queue. A worker runs the newest
+// task of its own queue first and steals the oldest task of another queue
+// when its own is empty, so uneven tasks are balanced over the workers.
+class ThreadPool {
+public:
+  // Start the given number of workers, by default one per core.
+  explicit ThreadPool(int numThreads = std::thread::hardware_concurrency());
+
+  // Finish all submitted tasks and stop the workers.
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  // Queue a task for one of the workers.
+  void submit(std::function<void()> task);
+
+  // Block until every submitted task has finished. Must not be called from
+  // inside a task.
+  void wait();
+
+  // Run body(0) ... body(count - 1) on the workers and wait for all of them.
+  void parallelFor(int count, const std::function<void(int)> &body);
+
+  // Return the number of workers. Counts the queues, which are complete
+  // before the first worker starts, while workers_ still grows.
+  int numThreads() const { return static_cast<int>(queues_.size()); }
+
+  // Return how many tasks were stolen from another worker's queue.
+  long numSteals() const;
+
+private:
+  // Tasks of one worker
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  // Main loop of each worker.
+  void work(int index);
+
+  // Take the newest task of the own queue or steal the oldest task of another
+  // queue. Return false if all queues are empty.
+  bool takeTask(int index, std::function<void()> &task);
+
+  std::vector<std::thread> workers_;
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+
+  // Guards the counters below and the sleeping of idle workers
+  mutable std::mutex mutex_;
+  // Signaled when a task was queued or the pool stops
+  std::condition_variable taskAvailable_;
+  // Signaled when the last pending task finished
+  std::condition_variable allDone_;
+  // Number of tasks that were submitted but did not finish yet
+  int pending_ = 0;
+  // Number of tasks waiting in the queues
+  int queued_ = 0;
+  // Queue for the next task submitted from outside
+  int nextQueue_ = 0;
+  long numSteals_ = 0;
+  bool stop_ = false;
+};
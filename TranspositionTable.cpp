@@ -0,0 +1,21 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#include "TranspositionTable.h"
+
+TranspositionTable::TranspositionTable(int log2Size)
+    : slots_(new Slot[std::uint64_t{1} << log2Size]),
+      mask_((std::uint64_t{1} << log2Size) - 1) {
+  clear();
+}
+
+// ____________________________________________________________________________
+
+void TranspositionTable::clear() {
+  // Empty slot i looks like an entry for key i + 1, which belongs to
+  // another slot, so no probe finds it
+  for (std::uint64_t i = 0; i <= mask_; ++i) {
+    slots_[i].checked.store(i + 1, std::memory_order_relaxed);
+    slots_[i].value.store(0, std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,58 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// A fixed-size hash table from 64-bit keys (Zobrist hashes) to 64-bit values
+// which many threads can use at the same time without locks. Every key has
+// exactly one slot, a newer entry replaces an older one. A slot stores
+// `key ^ value` next to `value`, so a slot which was half written by one
+// thread while another one read it doesn't match its key and counts as
+// empty instead of giving a wrong value.
+class TranspositionTable {
+public:
+  // Create a table with 2^log2Size slots, 16 bytes each. `log2Size` must be
+  // at least 1.
+  explicit TranspositionTable(int log2Size = 16);
+
+  TranspositionTable(const TranspositionTable &) = delete;
+  TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+  // Look up the value stored for `key`. Return false if there is none.
+  bool probe(std::uint64_t key, std::uint64_t &value) const {
+    const Slot &slot = slots_[key & mask_];
+    std::uint64_t checked = slot.checked.load(std::memory_order_relaxed);
+    std::uint64_t data = slot.value.load(std::memory_order_relaxed);
+    if ((checked ^ data) != key) {
+      return false;
+    }
+    value = data;
+    return true;
+  }
+
+  // Store `value` for `key`, replacing what was in its slot.
+  void store(std::uint64_t key, std::uint64_t value) {
+    Slot &slot = slots_[key & mask_];
+    slot.checked.store(key ^ value, std::memory_order_relaxed);
+    slot.value.store(value, std::memory_order_relaxed);
+  }
+
+  // Remove all entries. Must not run at the same time as probe/store.
+  void clear();
+
+  // Return the number of slots.
+  std::uint64_t size() const { return mask_ + 1; }
+
+private:
+  struct Slot {
+    std::atomic<std::uint64_t> checked;
+    std::atomic<std::uint64_t> value;
+  };
+
+  std::unique_ptr<Slot[]> slots_;
+  std::uint64_t mask_;
+};
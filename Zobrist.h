@@ -0,0 +1,44 @@
+// Copyright Paul Tröster
+// Ü11 - Uni Freiburg
+
+#pragma once
+
+#include "Tetromino.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Random keys for Zobrist hashing. The hash of a set of features (occupied
+// cells, the active piece) is the XOR of their keys, so adding or removing
+// a feature is one XOR. The keys are generated with splitmix64 at compile
+// time, every build and every run gets the same keys.
+template <std::size_t N>
+constexpr std::array<std::uint64_t, N> zobristKeys(std::uint64_t seed) {
+  std::array<std::uint64_t, N> keys{};
+  for (std::size_t i = 0; i < N; ++i) {
+    seed += 0x9E3779B97F4A7C15ULL;
+    std::uint64_t z = seed;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    keys[i] = z ^ (z >> 31);
+  }
+  return keys;
+}
+
+// Keys of the active piece: one per type and rotation and one per position.
+// Positions are given as y * positionStride_ + x.
+struct PieceKeys {
+  static constexpr int positionStride_ = 16;
+  static constexpr int numPositions_ = 32 * positionStride_;
+
+  static constexpr std::array<std::uint64_t, 7 * 4> shapes_ =
+      zobristKeys<7 * 4>(0x5A0B);
+  static constexpr std::array<std::uint64_t, numPositions_> positions_ =
+      zobristKeys<numPositions_>(0x9051);
+
+  // Key of a piece of the given type and rotation at position (x, y)
+  static std::uint64_t get(TetrominoType type, int rotation, int x, int y) {
+    return shapes_[static_cast<int>(type) * 4 + rotation] ^
+           positions_[y * positionStride_ + x];
+  }
+};